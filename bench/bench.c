@@ -0,0 +1,452 @@
+// Headless QuickUI benchmark: no window, no GPU.
+//
+// Widgets are driven through counting no-op callbacks (or the software renderer) so the
+// numbers measure the library itself. Run `make -C bench run`, or `./bench [frames]`.
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Count every heap allocation the library makes
+static size_t alloc_calls = 0;
+static size_t alloc_bytes = 0;
+
+static void *bench_malloc(size_t size) {
+    alloc_calls++;
+    alloc_bytes += size;
+    return malloc(size);
+}
+
+static void *bench_realloc(void *ptr, size_t size) {
+    alloc_calls++;
+    alloc_bytes += size;
+    return realloc(ptr, size);
+}
+
+#define QUI_MALLOC(size) bench_malloc(size)
+#define QUI_REALLOC(ptr, size) bench_realloc(ptr, size)
+#define QUI_IMPLEMENTATION
+#define QUI_SOFTWARE_RENDERER
+#include "quickui.h"
+
+#define SCREEN_WIDTH 1920
+#define SCREEN_HEIGHT 1080
+#define MICRO_WIDGETS 1000
+#define MICRO_WINDOWS 16
+
+// COUNTING BACKEND
+typedef struct {
+    long rects;
+    long texts;
+    long images;
+    long clips;
+    long measures;
+} Counters;
+
+static Counters counters;
+
+static void null_draw_rect(qui_Context *ctx, float x, float y, float w, float h, qui_Color col) {
+    (void)ctx; (void)x; (void)y; (void)w; (void)h; (void)col;
+    counters.rects++;
+}
+
+static void null_draw_text(qui_Context *ctx, const char *text, float x, float y) {
+    (void)ctx; (void)text; (void)x; (void)y;
+    counters.texts++;
+}
+
+static void null_draw_image(qui_Context *ctx, qui_Image *img, float x, float y, float w, float h) {
+    (void)ctx; (void)img; (void)x; (void)y; (void)w; (void)h;
+    counters.images++;
+}
+
+static void null_set_clip(qui_Context *ctx, const qui_Rect *clip) {
+    (void)ctx; (void)clip;
+    counters.clips++;
+}
+
+static float null_text_width(qui_Context *ctx, const char *text) {
+    (void)ctx;
+    counters.measures++;
+    return 8.0f * (float)strlen(text);
+}
+
+static float null_text_height(qui_Context *ctx, const char *text) {
+    (void)ctx; (void)text;
+    counters.measures++;
+    return 16.0f;
+}
+
+// TIMING
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile(const double *sorted, int count, double p) {
+    int index = (int)(p * (double)(count - 1) + 0.5);
+    return sorted[index];
+}
+
+// SHARED WIDGET DATA
+typedef enum {
+    WIDGET_BUTTON,
+    WIDGET_CHECKBOX,
+    WIDGET_SLIDER,
+    WIDGET_TEXTBOX,
+    WIDGET_IMAGE_BUTTON,
+    WIDGET_IMAGE_LABEL,
+    WIDGET_IMAGE_VERTICAL,
+    WIDGET_WINDOW,
+    WIDGET_MIXED
+} WidgetKind;
+
+static const char *widget_names[] = {
+    "button", "checkbox", "slider", "textbox", "image_button",
+    "image_button_with_label", "image_button_vertical", "window", "mixed"
+};
+
+static int *checks;
+static float *values;
+static char (*texts)[32];
+static qui_Vec2 window_pos[MICRO_WINDOWS];
+static uint32_t image_pixels[16 * 16];
+static qui_Image image;
+
+static void alloc_widget_data(int count) {
+    checks = (int*)calloc((size_t)count, sizeof(int));
+    values = (float*)calloc((size_t)count, sizeof(float));
+    texts = (char (*)[32])calloc((size_t)count, sizeof(*texts));
+    if (!checks || !values || !texts) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    for (int i = 0; i < count; i++) {
+        values[i] = (float)(i % 100);
+        snprintf(texts[i], sizeof(texts[i]), "item %d", i);
+    }
+    for (int i = 0; i < MICRO_WINDOWS; i++) {
+        window_pos[i] = qui_vec2((float)(i * 40), (float)(i * 20));
+    }
+}
+
+static void free_widget_data(void) {
+    free(checks);
+    free(values);
+    free(texts);
+}
+
+static void run_widget(qui_Context *ctx, WidgetKind kind, int i) {
+    switch (kind) {
+        case WIDGET_BUTTON:         qui_button(ctx, "Button"); break;
+        case WIDGET_CHECKBOX:       qui_checkbox(ctx, "Checkbox", &checks[i]); break;
+        case WIDGET_SLIDER:         qui_slider(ctx, "Slider", &values[i], 0.0f, 100.0f, 150.0f); break;
+        case WIDGET_TEXTBOX:        qui_textbox(ctx, texts[i], sizeof(texts[i]), 150.0f); break;
+        case WIDGET_IMAGE_BUTTON:   qui_image_button(ctx, &image, 0, 0, 0, 0); break;
+        case WIDGET_IMAGE_LABEL:    qui_image_button_with_label(ctx, &image, "Image", 0, 0); break;
+        case WIDGET_IMAGE_VERTICAL: qui_image_button_vertical(ctx, &image, "Image", 0, 0); break;
+        case WIDGET_WINDOW:
+            if (qui_begin_window(ctx, texts[i], qui_vec2(300, 200), &window_pos[i])) {
+                qui_button(ctx, "Inside");
+                qui_end_window(ctx);
+            }
+            break;
+        case WIDGET_MIXED:
+            run_widget(ctx, (WidgetKind)(i % 4), i);
+            break;
+    }
+}
+
+// BENCHMARK DRIVER
+typedef enum {
+    MODE_CALLBACKS,
+    MODE_DRAW_LIST,
+    MODE_SOFTWARE,
+    MODE_ATLAS
+} Mode;
+
+static const char *mode_names[] = { "callbacks", "draw list", "software", "atlas" };
+
+typedef struct {
+    double *frame_ns;
+    int frames;
+    double widgets_per_frame;
+    Counters per_frame;
+    size_t allocs;
+    size_t alloc_bytes;
+} Result;
+
+static uint32_t *framebuffer_pixels;
+static qui_Font atlas_font;
+
+static Result run_bench(WidgetKind kind, int count, int columns, Mode mode, int frames) {
+    Result result;
+    memset(&result, 0, sizeof(result));
+    result.frames = frames;
+    result.widgets_per_frame = count;
+    result.frame_ns = (double*)malloc(sizeof(double) * (size_t)frames);
+    if (!result.frame_ns) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+
+    qui_Context ctx;
+    qui_Framebuffer fb;
+    qui_VertexBuffer vb;
+    memset(&vb, 0, sizeof(vb));
+    qui_init(&ctx, NULL);
+    ctx.draw_rect = null_draw_rect;
+    ctx.draw_text = null_draw_text;
+    ctx.draw_image = null_draw_image;
+    ctx.set_clip = null_set_clip;
+    ctx.text_width = null_text_width;
+    ctx.text_height = null_text_height;
+
+    if (mode == MODE_DRAW_LIST) {
+        qui_enable_draw_list(&ctx, count * 8 + 64);
+    } else if (mode == MODE_SOFTWARE) {
+        qui_framebuffer_init(&fb, framebuffer_pixels, SCREEN_WIDTH, SCREEN_HEIGHT, 0);
+        qui_use_software_renderer(&ctx, &fb);
+    } else if (mode == MODE_ATLAS) {
+        // Built-in font: measurement is a table lookup, text and rects tessellate into one batch
+        qui_enable_draw_list(&ctx, count * 8 + 64);
+        qui_use_font(&ctx, &atlas_font);
+        qui_vertex_buffer_init(&vb, count * 48 + 256, 4);
+    }
+
+    // A few frames to warm the caches and grow the state store
+    int warmup = 3;
+    for (int f = -warmup; f < frames; f++) {
+        if (f == 0) {
+            memset(&counters, 0, sizeof(counters));
+            alloc_calls = 0;
+            alloc_bytes = 0;
+        }
+
+        // Sweep the mouse so hover moves between widgets
+        qui_mouse_move(&ctx, (f * 37) % SCREEN_WIDTH, (f * 23) % SCREEN_HEIGHT);
+
+        double start = now_ns();
+        if (mode == MODE_SOFTWARE) {
+            qui_framebuffer_clear(&fb, qui_color(32, 32, 32, 255));
+        }
+        qui_begin(&ctx, 10, 10);
+        if (columns > 1) {
+            qui_layout_row(&ctx, columns, NULL, SCREEN_WIDTH - 20);
+        }
+        for (int i = 0; i < count; i++) {
+            qui_push_id_int(&ctx, i);
+            run_widget(&ctx, kind, i);
+            qui_pop_id(&ctx);
+        }
+        if (columns > 1) {
+            qui_layout_end(&ctx);
+        }
+        qui_end(&ctx);
+        if (mode == MODE_DRAW_LIST) {
+            qui_render_draw_list(&ctx, qui_get_draw_list(&ctx));
+        } else if (mode == MODE_ATLAS) {
+            qui_build_vertex_buffer(qui_get_draw_list(&ctx), &vb);
+        }
+        double elapsed = now_ns() - start;
+
+        if (f >= 0) result.frame_ns[f] = elapsed;
+    }
+
+    result.per_frame.rects = counters.rects / frames;
+    result.per_frame.texts = counters.texts / frames;
+    result.per_frame.images = counters.images / frames;
+    result.per_frame.clips = counters.clips / frames;
+    result.per_frame.measures = counters.measures / frames;
+    result.allocs = alloc_calls;
+    result.alloc_bytes = alloc_bytes;
+
+    qui_vertex_buffer_free(&vb);
+    qui_cleanup(&ctx);
+    qsort(result.frame_ns, (size_t)frames, sizeof(double), compare_double);
+    return result;
+}
+
+// TEXT MEASUREMENT
+typedef enum {
+    MEASURE_CALLBACK,
+    MEASURE_TABLE,
+    MEASURE_ATLAS
+} MeasureMode;
+
+static const char *measure_names[] = { "text_width callback", "advance table", "atlas font" };
+static float advance_table[256];
+
+// Measures count distinct strings per pass, more than the text cache holds, like a large table view
+static double run_measure(MeasureMode mode, int count, int passes) {
+    qui_Context ctx;
+    qui_init(&ctx, NULL);
+    ctx.text_width = null_text_width;
+    if (mode == MEASURE_TABLE) qui_set_font_advances(&ctx, advance_table, NULL);
+    if (mode == MEASURE_ATLAS) qui_use_font(&ctx, &atlas_font);
+
+    volatile float sink = 0.0f;
+    double start = now_ns();
+    for (int pass = 0; pass < passes; pass++) {
+        for (int i = 0; i < count; i++) {
+            sink += qui_get_text_width(&ctx, texts[i]);
+        }
+    }
+    double elapsed = now_ns() - start;
+    (void)sink;
+
+    qui_cleanup(&ctx);
+    return elapsed / ((double)count * passes);
+}
+
+// IMAGE TOOLBAR
+#define TOOLBAR_ICONS 200
+
+static uint32_t icon_pixels[TOOLBAR_ICONS][16 * 16];
+static qui_Image icons[TOOLBAR_ICONS];
+static qui_Image packed_icons[TOOLBAR_ICONS];
+
+// One frame of 200 image buttons tessellated into a vertex buffer; returns ns per frame
+static double run_toolbar(qui_Image *set, int passes, int *batches) {
+    qui_Context ctx;
+    qui_VertexBuffer vb;
+    qui_init(&ctx, NULL);
+    ctx.draw_rect = null_draw_rect;
+    ctx.draw_image = null_draw_image;
+    ctx.text_width = null_text_width;
+    ctx.text_height = null_text_height;
+    qui_enable_draw_list(&ctx, TOOLBAR_ICONS * 2 + 64);
+    qui_vertex_buffer_init(&vb, TOOLBAR_ICONS * 2 + 64, 2);
+
+    double start = 0.0;
+    for (int pass = -3; pass < passes; pass++) {
+        if (pass == 0) start = now_ns();
+        qui_mouse_move(&ctx, (pass * 37) % SCREEN_WIDTH, 20);
+        qui_begin(&ctx, 10, 10);
+        qui_layout_row(&ctx, 50, NULL, SCREEN_WIDTH - 20);
+        for (int i = 0; i < TOOLBAR_ICONS; i++) {
+            qui_image_button(&ctx, &set[i], 32, 32, 0, 0);
+        }
+        qui_layout_end(&ctx);
+        qui_end(&ctx);
+        qui_build_vertex_buffer(qui_get_draw_list(&ctx), &vb);
+    }
+    double elapsed = now_ns() - start;
+    *batches = vb.batch_count;
+
+    qui_vertex_buffer_free(&vb);
+    qui_cleanup(&ctx);
+    return elapsed / passes;
+}
+
+static void print_micro(const char *name, Result *r) {
+    double per = r->widgets_per_frame;
+    printf("%-24s %8.1f %8.1f %8.1f %8.1f   %5.1f %5.1f %5.1f %5.1f %6.1f   %6zu\n",
+        name,
+        percentile(r->frame_ns, r->frames, 0.50) / per,
+        percentile(r->frame_ns, r->frames, 0.90) / per,
+        percentile(r->frame_ns, r->frames, 0.99) / per,
+        r->frame_ns[r->frames - 1] / per,
+        (double)r->per_frame.rects / per, (double)r->per_frame.texts / per,
+        (double)r->per_frame.images / per, (double)r->per_frame.clips / per,
+        (double)r->per_frame.measures / per, r->allocs);
+}
+
+static void print_macro(int count, Mode mode, Result *r) {
+    double mean = 0.0;
+    for (int i = 0; i < r->frames; i++) mean += r->frame_ns[i];
+    mean /= r->frames;
+
+    printf("%7d  %-10s %9.1f %9.1f %9.1f %9.1f %8.1f   %8ld %8ld %8ld   %6zu %9zu\n",
+        count, mode_names[mode],
+        percentile(r->frame_ns, r->frames, 0.50) / 1000.0,
+        percentile(r->frame_ns, r->frames, 0.90) / 1000.0,
+        percentile(r->frame_ns, r->frames, 0.99) / 1000.0,
+        r->frame_ns[r->frames - 1] / 1000.0,
+        mean / count,
+        r->per_frame.rects, r->per_frame.texts, r->per_frame.measures,
+        r->allocs, r->alloc_bytes);
+}
+
+int main(int argc, char **argv) {
+    int frames = (argc > 1) ? atoi(argv[1]) : 200;
+    if (frames < 1) frames = 1;
+
+    static const int macro_counts[] = { 1000, 10000, 100000 };
+    int max_count = macro_counts[2];
+    alloc_widget_data(max_count);
+    image = qui_image(image_pixels, 16, 16, 4);
+    framebuffer_pixels = (uint32_t*)calloc((size_t)SCREEN_WIDTH * SCREEN_HEIGHT, sizeof(uint32_t));
+    if (!framebuffer_pixels) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    qui_font_init_default(&atlas_font, 2);
+    for (int i = 0; i < 256; i++) advance_table[i] = 8.0f;
+
+    printf("QuickUI benchmark: %d measured frames, counting no-op backend\n\n", frames);
+
+    printf("Per widget (%d widgets per frame, windows: %d)\n", MICRO_WIDGETS, MICRO_WINDOWS);
+    printf("%-24s %8s %8s %8s %8s   %5s %5s %5s %5s %6s   %6s\n",
+        "widget", "p50 ns", "p90 ns", "p99 ns", "max ns",
+        "rect", "text", "image", "clip", "measure", "allocs");
+    for (int kind = WIDGET_BUTTON; kind <= WIDGET_WINDOW; kind++) {
+        int count = (kind == WIDGET_WINDOW) ? MICRO_WINDOWS : MICRO_WIDGETS;
+        Result r = run_bench((WidgetKind)kind, count, 1, MODE_CALLBACKS, frames);
+        print_micro(widget_names[kind], &r);
+        free(r.frame_ns);
+    }
+
+    printf("\nWhole frames (mixed widgets in 8 columns)\n");
+    printf("%7s  %-10s %9s %9s %9s %9s %8s   %8s %8s %8s   %6s %9s\n",
+        "widgets", "backend", "p50 us", "p90 us", "p99 us", "max us", "ns/wdgt",
+        "rects", "texts", "measures", "allocs", "bytes");
+    for (int c = 0; c < 3; c++) {
+        int count = macro_counts[c];
+        int scaled = frames * 1000 / count;
+        if (scaled < 5) scaled = 5;
+        for (int mode = MODE_CALLBACKS; mode <= MODE_ATLAS; mode++) {
+            Result r = run_bench(WIDGET_MIXED, count, 8, (Mode)mode, scaled);
+            print_macro(count, (Mode)mode, &r);
+            free(r.frame_ns);
+        }
+    }
+
+    printf("\nText measurement (%d distinct strings)\n", max_count);
+    printf("%-24s %8s\n", "path", "ns/string");
+    for (int mode = MEASURE_CALLBACK; mode <= MEASURE_ATLAS; mode++) {
+        printf("%-24s %8.1f\n", measure_names[mode], run_measure((MeasureMode)mode, max_count, 10));
+    }
+
+    qui_ImageAtlas image_atlas;
+    qui_image_atlas_init(&image_atlas, 512, 512);
+    for (int i = 0; i < TOOLBAR_ICONS; i++) {
+        icons[i] = qui_image(icon_pixels[i], 16, 16, 4);
+        qui_image_atlas_add(&image_atlas, &icons[i], &packed_icons[i]);
+    }
+    printf("\nImage toolbar (%d icons, vertex buffer)\n", TOOLBAR_ICONS);
+    printf("%-24s %8s %8s\n", "images", "us/frame", "batches");
+    int batches = 0;
+    double toolbar_ns = run_toolbar(icons, frames, &batches);
+    printf("%-24s %8.1f %8d\n", "separate", toolbar_ns / 1000.0, batches);
+    toolbar_ns = run_toolbar(packed_icons, frames, &batches);
+    printf("%-24s %8.1f %8d\n", "image atlas", toolbar_ns / 1000.0, batches);
+    qui_image_atlas_free(&image_atlas);
+
+    printf("\nallocs/bytes: heap allocations made by the library during the measured frames\n");
+
+    free(framebuffer_pixels);
+    qui_font_free(&atlas_font);
+    free_widget_data();
+    return 0;
+}
@@ -0,0 +1,220 @@
+// Headless comparison of the C API and the quickui.hpp wrapper.
+//
+// The same mixed frame (buttons, checkboxes, sliders, text boxes in 8 columns) is drawn
+// through C callbacks, through a C draw list replayed by qui_render_draw_list(), and
+// through qui::Context with a statically bound backend, both directly and replaying its
+// draw list. Every backend only counts.
+// Run `make -C bench run_cpp`, or `./bench_cpp [frames]`.
+
+#define QUI_IMPLEMENTATION
+#include "quickui.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#define SCREEN_WIDTH 1920
+#define ROUNDS 5
+
+// COUNTING BACKENDS
+struct Counters {
+    long rects;
+    long texts;
+    long measures;
+};
+
+static Counters counters;
+
+static void null_draw_rect(qui_Context *, float, float, float, float, qui_Color) { counters.rects++; }
+static void null_draw_text(qui_Context *, const char *, float, float) { counters.texts++; }
+static void null_draw_image(qui_Context *, qui_Image *, float, float, float, float) {}
+static void null_set_clip(qui_Context *, const qui_Rect *) {}
+
+static float null_text_width(qui_Context *, const char *text) {
+    counters.measures++;
+    return 8.0f * (float)std::strlen(text);
+}
+
+static float null_text_height(qui_Context *, const char *) {
+    counters.measures++;
+    return 16.0f;
+}
+
+struct NullBackend {
+    static void draw_rect(float, float, float, float, qui_Color32) { counters.rects++; }
+    static void draw_text(const char *, float, float, qui_Color32) { counters.texts++; }
+    static void draw_image(qui_Image *, float, float, float, float) {}
+    static void set_clip(const qui_Rect *) {}
+    static float text_width(const char *text) { return null_text_width(nullptr, text); }
+    static float text_height(const char *text) { return null_text_height(nullptr, text); }
+};
+
+// TIMING
+static double now_ns() {
+    using namespace std::chrono;
+    return (double)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// SHARED WIDGET DATA
+static std::vector<int> checks;
+static std::vector<float> values;
+static std::vector<std::array<char, 32>> texts;
+
+static const char *labels[] = { "Button", "Checkbox", "Slider" };
+static const std::string_view label_views[] = { "Button", "Checkbox", "Slider" };
+
+static void alloc_widget_data(int count) {
+    checks.assign((size_t)count, 0);
+    values.assign((size_t)count, 0.0f);
+    texts.assign((size_t)count, std::array<char, 32>());
+    for (int i = 0; i < count; i++) {
+        values[(size_t)i] = (float)(i % 100);
+        std::snprintf(texts[(size_t)i].data(), 32, "item %d", i);
+    }
+}
+
+static void run_widget_c(qui_Context *ctx, int i) {
+    switch (i % 4) {
+        case 0: qui_button(ctx, labels[0]); break;
+        case 1: qui_checkbox(ctx, labels[1], &checks[(size_t)i]); break;
+        case 2: qui_slider(ctx, labels[2], &values[(size_t)i], 0.0f, 100.0f, 150.0f); break;
+        case 3: qui_textbox(ctx, texts[(size_t)i].data(), 32, 150.0f); break;
+    }
+}
+
+template <class Ui, class Label>
+static void run_widget_cpp(Ui &ui, const Label *names, int i) {
+    switch (i % 4) {
+        case 0: ui.button(names[0]); break;
+        case 1: ui.checkbox(names[1], &checks[(size_t)i]); break;
+        case 2: ui.slider(names[2], &values[(size_t)i], 0.0f, 100.0f, 150.0f); break;
+        case 3: ui.textbox(texts[(size_t)i].data(), 32, 150.0f); break;
+    }
+}
+
+// BENCHMARK DRIVER
+enum Mode {
+    MODE_C_CALLBACKS,
+    MODE_C_DRAW_LIST,
+    MODE_CPP,
+    MODE_CPP_DRAW_LIST,
+    MODE_CPP_VIEWS
+};
+
+static const char *mode_names[] = { "C callbacks", "C draw list", "C++ wrapper", "C++ draw list", "C++ string_view" };
+
+struct Result {
+    double p50_ns;
+    long rects;
+};
+
+static Result summarize(std::vector<double> &frame_ns, int frames) {
+    Result result;
+    std::sort(frame_ns.begin(), frame_ns.end());
+    result.p50_ns = frame_ns[frame_ns.size() / 2];
+    result.rects = counters.rects / frames;
+    return result;
+}
+
+static Result run_c(int count, Mode mode, int frames) {
+    qui_Context ctx;
+    qui_init(&ctx, NULL);
+    ctx.draw_rect = null_draw_rect;
+    ctx.draw_text = null_draw_text;
+    ctx.draw_image = null_draw_image;
+    ctx.set_clip = null_set_clip;
+    ctx.text_width = null_text_width;
+    ctx.text_height = null_text_height;
+    if (mode == MODE_C_DRAW_LIST) {
+        qui_enable_draw_list(&ctx, count * 8 + 64);
+    }
+
+    std::vector<double> frame_ns;
+    for (int f = -3; f < frames; f++) {
+        if (f == 0) counters = Counters();
+        qui_mouse_move(&ctx, (f * 37) % SCREEN_WIDTH, (f * 23) % 1080);
+
+        double start = now_ns();
+        qui_begin(&ctx, 10, 10);
+        qui_layout_row(&ctx, 8, NULL, SCREEN_WIDTH - 20);
+        for (int i = 0; i < count; i++) {
+            qui_push_id_int(&ctx, i);
+            run_widget_c(&ctx, i);
+            qui_pop_id(&ctx);
+        }
+        qui_layout_end(&ctx);
+        qui_end(&ctx);
+        if (mode == MODE_C_DRAW_LIST) {
+            qui_render_draw_list(&ctx, qui_get_draw_list(&ctx));
+        }
+        double elapsed = now_ns() - start;
+
+        if (f >= 0) frame_ns.push_back(elapsed);
+    }
+
+    qui_cleanup(&ctx);
+    return summarize(frame_ns, frames);
+}
+
+static Result run_cpp(int count, Mode mode, int frames) {
+    qui::Context<NullBackend> ui((mode == MODE_CPP_DRAW_LIST) ? count * 8 + 64 : 0);
+
+    std::vector<double> frame_ns;
+    for (int f = -3; f < frames; f++) {
+        if (f == 0) counters = Counters();
+        ui.mouse_move((f * 37) % SCREEN_WIDTH, (f * 23) % 1080);
+
+        double start = now_ns();
+        ui.begin(10, 10);
+        qui_layout_row(ui.raw(), 8, NULL, SCREEN_WIDTH - 20);
+        for (int i = 0; i < count; i++) {
+            auto scope = ui.id(i);
+            if (mode == MODE_CPP_VIEWS) run_widget_cpp(ui, label_views, i);
+            else run_widget_cpp(ui, labels, i);
+        }
+        qui_layout_end(ui.raw());
+        ui.end();
+        double elapsed = now_ns() - start;
+
+        if (f >= 0) frame_ns.push_back(elapsed);
+    }
+
+    return summarize(frame_ns, frames);
+}
+
+int main(int argc, char **argv) {
+    int frames = (argc > 1) ? std::atoi(argv[1]) : 200;
+    if (frames < 1) frames = 1;
+
+    static const int counts[] = { 1000, 10000, 100000 };
+    alloc_widget_data(counts[2]);
+
+    std::printf("QuickUI C++ wrapper benchmark: counting no-op backends\n\n");
+    std::printf("%7s  %-16s %9s %8s %8s\n", "widgets", "api", "p50 us", "ns/wdgt", "rects");
+    for (int count : counts) {
+        int scaled = frames * 1000 / count;
+        if (scaled < 5) scaled = 5;
+        // Modes take turns over several rounds and keep their best median, so a noisy
+        // stretch on the machine does not land on one of them only
+        Result best[MODE_CPP_VIEWS + 1];
+        for (int round = 0; round < ROUNDS; round++) {
+            for (int mode = MODE_C_CALLBACKS; mode <= MODE_CPP_VIEWS; mode++) {
+                Result r = (mode <= MODE_C_DRAW_LIST) ? run_c(count, (Mode)mode, scaled)
+                                                     : run_cpp(count, (Mode)mode, scaled);
+                if (round == 0 || r.p50_ns < best[mode].p50_ns) best[mode] = r;
+            }
+        }
+        for (int mode = MODE_C_CALLBACKS; mode <= MODE_CPP_VIEWS; mode++) {
+            const Result &r = best[mode];
+            std::printf("%7d  %-16s %9.1f %8.1f %8ld\n", count, mode_names[mode],
+                r.p50_ns / 1000.0, r.p50_ns / count, r.rects);
+        }
+    }
+
+    return 0;
+}
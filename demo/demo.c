@@ -37,6 +37,14 @@ void raylib_draw_image(qui_Context* ctx, qui_Image *img, float x, float y, float
     DrawTexturePro(*texture, source, dest, origin, 0.0f, WHITE);
 }
 
+void raylib_set_clip(qui_Context* ctx, const qui_Rect *clip) {
+    if (clip) {
+        BeginScissorMode(clip->pos_x, clip->pos_y, clip->width, clip->height);
+    } else {
+        EndScissorMode();
+    }
+}
+
 float raylib_text_width(qui_Context* ctx, const char *text) {
     Font *font = (Font *)ctx->font;
     if (!font) {
@@ -81,6 +89,7 @@ int main(void) {
     ctx.draw_rect = raylib_draw_rect;
     ctx.draw_text = raylib_draw_text;
     ctx.draw_image = raylib_draw_image;
+    ctx.set_clip = raylib_set_clip;
     ctx.text_width = raylib_text_width;
     ctx.text_height = raylib_text_height;
     
@@ -89,10 +98,10 @@ int main(void) {
     Texture2D delete_texture = CreateColoredTexture(32, 32, RED);
     Texture2D settings_texture = CreateColoredTexture(24, 24, PURPLE);
     
-    qui_Image save_icon = { &save_texture, save_texture.width, save_texture.height, 4 };
-    qui_Image load_icon = { &load_texture, load_texture.width, load_texture.height, 4 };
-    qui_Image delete_icon = { &delete_texture, delete_texture.width, delete_texture.height, 4 };
-    qui_Image settings_icon = { &settings_texture, settings_texture.width, settings_texture.height, 4 };
+    qui_Image save_icon = qui_image(&save_texture, save_texture.width, save_texture.height, 4);
+    qui_Image load_icon = qui_image(&load_texture, load_texture.width, load_texture.height, 4);
+    qui_Image delete_icon = qui_image(&delete_texture, delete_texture.width, delete_texture.height, 4);
+    qui_Image settings_icon = qui_image(&settings_texture, settings_texture.width, settings_texture.height, 4);
     
     static int checkbox_value = 0;
     static float slider_value = 50.0f;
@@ -103,6 +112,10 @@ int main(void) {
     static int load_clicks = 0;
     static int delete_clicks = 0;
 
+    static const char notes_text[] = "Multi-line notes\nEnter starts a new line\nArrows, Page Up/Down move the caret";
+    qui_TextDoc notes;
+    qui_textdoc_init(&notes, notes_text, sizeof(notes_text) - 1);
+
     static qui_vec2_t window_size = { 450, 500 };
     static qui_vec2_t window_pos = { 50, 50 };
     static int show_popup = 0;
@@ -131,19 +144,24 @@ int main(void) {
         if (ctx.keyboard_focus_id > 0) {
             int key = GetCharPressed();
             while (key > 0) {
-                if (key >= 32 && key <= 125) {
-                    size_t len = strlen(textbox_buffer);
-                    if (len < sizeof(textbox_buffer) - 1) {
-                        textbox_buffer[len] = (char)key;
-                        textbox_buffer[len + 1] = '\0';
-                    }
-                }
+                qui_feed_char(&ctx, (uint32_t)key);
                 key = GetCharPressed();
             }
             
-            if (IsKeyPressed(KEY_BACKSPACE)) {
+            int shift = (IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT)) ? QUI_KEY_SHIFT : 0;
+            if (IsKeyPressed(KEY_BACKSPACE) || IsKeyPressedRepeat(KEY_BACKSPACE)) {
                 qui_feed_key_backspace(&ctx);
             }
+            if (IsKeyPressed(KEY_DELETE) || IsKeyPressedRepeat(KEY_DELETE)) qui_feed_key(&ctx, QUI_KEY_DELETE);
+            if (IsKeyPressed(KEY_LEFT) || IsKeyPressedRepeat(KEY_LEFT)) qui_feed_key(&ctx, QUI_KEY_LEFT | shift);
+            if (IsKeyPressed(KEY_RIGHT) || IsKeyPressedRepeat(KEY_RIGHT)) qui_feed_key(&ctx, QUI_KEY_RIGHT | shift);
+            if (IsKeyPressed(KEY_HOME)) qui_feed_key(&ctx, QUI_KEY_HOME | shift);
+            if (IsKeyPressed(KEY_END)) qui_feed_key(&ctx, QUI_KEY_END | shift);
+            if (IsKeyPressed(KEY_UP) || IsKeyPressedRepeat(KEY_UP)) qui_feed_key(&ctx, QUI_KEY_UP | shift);
+            if (IsKeyPressed(KEY_DOWN) || IsKeyPressedRepeat(KEY_DOWN)) qui_feed_key(&ctx, QUI_KEY_DOWN | shift);
+            if (IsKeyPressed(KEY_PAGE_UP)) qui_feed_key(&ctx, QUI_KEY_PAGE_UP | shift);
+            if (IsKeyPressed(KEY_PAGE_DOWN)) qui_feed_key(&ctx, QUI_KEY_PAGE_DOWN | shift);
+            if (IsKeyDown(KEY_LEFT_CONTROL) && IsKeyPressed(KEY_A)) qui_feed_key(&ctx, QUI_KEY_SELECT_ALL);
             
             if (IsKeyPressed(KEY_ENTER)) {
                 qui_feed_key_enter(&ctx);
@@ -219,6 +237,8 @@ int main(void) {
         else DrawText(content_info, 50, (int)ctx.cursor_y, 16, LIGHTGRAY);
         ctx.cursor_y += 30;
         
+        qui_text_editor(&ctx, "Notes", &notes, 300.0f, 80.0f);
+        
         char debug_info[256];
         snprintf(debug_info, sizeof(debug_info), 
             "Mouse: (%d, %d) | Active ID: %u | Hot ID: %u | Focus ID: %u",
@@ -242,29 +262,22 @@ int main(void) {
             else DrawText("Toolbar:", ctx.layout_offset_x, ctx.layout_offset_y + ctx.cursor_y, 16, WHITE);
             ctx.cursor_y += 25;
             
-            float start_x = ctx.cursor_x;
-            float start_y = ctx.cursor_y;
+            qui_Size toolbar[3] = { qui_size_auto(), qui_size_auto(), qui_size_auto() };
+            qui_layout_row(&ctx, 3, toolbar, 0);
             
             if (qui_image_button(&ctx, &save_icon, 24, 24)) {
                 save_clicks++;
             }
             
-            ctx.cursor_x = start_x + 35;
-            ctx.cursor_y = start_y;
-            
             if (qui_image_button(&ctx, &load_icon, 24, 24)) {
                 load_clicks++;
             }
             
-            ctx.cursor_x = start_x + 70;
-            ctx.cursor_y = start_y;
-            
             if (qui_image_button(&ctx, &delete_icon, 24, 24)) {
                 delete_clicks++;
             }
             
-            ctx.cursor_x = start_x;
-            ctx.cursor_y = start_y + 35;
+            qui_layout_end(&ctx);
 
             qui_end_window(&ctx);
         }
@@ -278,6 +291,7 @@ int main(void) {
     UnloadTexture(load_texture);
     UnloadTexture(delete_texture);
     UnloadTexture(settings_texture);
+    qui_textdoc_free(&notes);
     
     CloseWindow();
     
@@ -16,6 +16,9 @@
  * - Window management with drag support
  * - Customizable colors and fonts
  * - Image button support
+ * - Optional draw command list recording
+ * - Batched vertex/index buffer output
+ * - Optional built-in software renderer (QUI_SOFTWARE_RENDERER)
  * - Error checking and validation
  * 
  * Usage:
@@ -96,6 +99,7 @@ int main() {
 #include <stdint.h>
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdio.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -108,6 +112,126 @@ extern "C" {
 /** @brief Unique identifier for UI elements */
 typedef uint32_t qui_Id;
 
+/** @brief Maximum nesting depth of qui_push_id() scopes */
+#ifndef QUI_ID_STACK_SIZE
+#define QUI_ID_STACK_SIZE 32
+#endif
+
+/** @brief Maximum nesting depth of qui_push_clip() regions */
+#ifndef QUI_CLIP_STACK_SIZE
+#define QUI_CLIP_STACK_SIZE 16
+#endif
+
+/** @brief Maximum nesting depth of windows, scroll regions and other layout scopes */
+#ifndef QUI_LAYOUT_STACK_SIZE
+#define QUI_LAYOUT_STACK_SIZE 16
+#endif
+
+/** @brief Maximum number of windows shown at the same time */
+#ifndef QUI_MAX_WINDOWS
+#define QUI_MAX_WINDOWS 32
+#endif
+
+/** @brief Maximum number of columns in a layout row (the cached row measurements must fit a state block) */
+#ifndef QUI_LAYOUT_MAX_COLUMNS
+#define QUI_LAYOUT_MAX_COLUMNS 12
+#endif
+
+/** @brief Maximum nesting depth of scroll regions */
+#ifndef QUI_SCROLL_STACK_SIZE
+#define QUI_SCROLL_STACK_SIZE 8
+#endif
+
+/** @brief Pixels scrolled per mouse wheel notch */
+#ifndef QUI_SCROLL_STEP
+#define QUI_SCROLL_STEP 40.0f
+#endif
+
+/** @brief Initial number of ID slots for duplicate detection (power of two, grows as needed) */
+#ifndef QUI_ID_CHECK_SIZE
+#define QUI_ID_CHECK_SIZE 1024
+#endif
+
+/** @brief Size in bytes of one per-widget state block */
+#ifndef QUI_STATE_BLOCK_SIZE
+#define QUI_STATE_BLOCK_SIZE 64
+#endif
+
+/** @brief Frames a widget state survives without being used (default) */
+#ifndef QUI_STATE_MAX_AGE
+#define QUI_STATE_MAX_AGE 120
+#endif
+
+/** @brief Frames to keep redrawing after the output last changed */
+#ifndef QUI_SETTLE_FRAMES
+#define QUI_SETTLE_FRAMES 1
+#endif
+
+/** @brief Maximum number of damage rectangles reported per frame */
+#ifndef QUI_MAX_DAMAGE_RECTS
+#define QUI_MAX_DAMAGE_RECTS 16
+#endif
+
+/** @brief Bytes of one line drawn by qui_text_editor(); longer lines are cut */
+#ifndef QUI_EDITOR_LINE_BYTES
+#define QUI_EDITOR_LINE_BYTES 512
+#endif
+
+/** @brief Key presses delivered to widgets per frame */
+#ifndef QUI_MAX_FRAME_KEYS
+#define QUI_MAX_FRAME_KEYS 16
+#endif
+
+/**
+ * @brief Input events buffered between frames (power of two)
+ *
+ * qui_feed_text() queues one event per code point, so this also limits the characters
+ * one call can deliver; longer text is rejected as a whole.
+ */
+#ifndef QUI_INPUT_QUEUE_SIZE
+#define QUI_INPUT_QUEUE_SIZE 256
+#endif
+
+/** @brief Bytes of UTF-8 text input delivered to widgets per frame */
+#ifndef QUI_TEXT_INPUT_SIZE
+#define QUI_TEXT_INPUT_SIZE 64
+#endif
+
+/** @brief Maximum nesting depth of traced scopes */
+#ifndef QUI_TRACE_STACK_SIZE
+#define QUI_TRACE_STACK_SIZE 32
+#endif
+
+/** @brief Bytes kept of each trace event name (including the terminator) */
+#ifndef QUI_TRACE_NAME_SIZE
+#define QUI_TRACE_NAME_SIZE 32
+#endif
+
+/** @brief Initial size in bytes of the per-frame arena (it grows when a frame needs more) */
+#ifndef QUI_FRAME_ARENA_SIZE
+#define QUI_FRAME_ARENA_SIZE (64 * 1024)
+#endif
+
+/** @brief Number of cached text measurements (power of two, multiple of 4) */
+#ifndef QUI_TEXT_CACHE_SIZE
+#define QUI_TEXT_CACHE_SIZE 512
+#endif
+
+/** @brief Glyphs per font: code points 0-255 (Latin-1); others draw as the fallback glyph */
+#ifndef QUI_FONT_GLYPH_COUNT
+#define QUI_FONT_GLYPH_COUNT 256
+#endif
+
+/** @brief Maximum skyline segments of an atlas packer */
+#ifndef QUI_SKYLINE_MAX_NODES
+#define QUI_SKYLINE_MAX_NODES 256
+#endif
+
+/** @brief Maximum pages of an image atlas */
+#ifndef QUI_IMAGE_ATLAS_MAX_PAGES
+#define QUI_IMAGE_ATLAS_MAX_PAGES 8
+#endif
+
 /** @brief Result codes for QuickUI operations */
 typedef enum {
     QUI_OK = 0,                /**< Operation successful */
@@ -115,7 +239,8 @@ typedef enum {
     QUI_ERROR_INVALID_VALUE,   /**< Invalid parameter value */
     QUI_ERROR_NOT_INITIALIZED, /**< Context not initialized */
     QUI_ERROR_BUFFER_TOO_SMALL,/**< Buffer capacity too small */
-    QUI_ERROR_INVALID_STATE    /**< Invalid operation for current state */
+    QUI_ERROR_INVALID_STATE,   /**< Invalid operation for current state */
+    QUI_ERROR_OUT_OF_MEMORY    /**< Memory allocation failed */
 } qui_Result;
 
 /** @brief 2D integer vector */
@@ -132,12 +257,32 @@ typedef struct {
     int a;
 } qui_Color;
 
-/** @brief Image data structure */
-typedef struct {
+/**
+ * @brief Packed RGBA8 color, R in the lowest byte (see qui_pack_color)
+ * 
+ * Style tables, draw commands and vertices store colors in this form; qui_Color is
+ * only used at the API edge.
+ */
+typedef uint32_t qui_Color32;
+
+/**
+ * @brief Image data structure
+ * 
+ * Images packed with qui_image_atlas_add() live inside an atlas page: data points at
+ * their first pixel, rows are page->width pixels apart, and backends draw them as the
+ * sub-rect given by qui_image_uv() of the page texture.
+ * 
+ * The atlas fields must be zero for a standalone image: create it with qui_image() or a
+ * zero-initialized struct, not by assigning the fields of an uninitialized one.
+ */
+typedef struct qui_Image {
     void *data;    /**< Pixel data */
     int width;     /**< Image width in pixels */
     int height;    /**< Image height in pixels */
     int channels;  /**< Number of color channels (1-4) */
+    struct qui_Image *page; /**< Atlas page holding the pixels, or NULL (pages point at themselves) */
+    int page_x;    /**< Left edge in the page */
+    int page_y;    /**< Top edge in the page */
 } qui_Image;
 
 /** @brief Rectangle definition */
@@ -148,6 +293,52 @@ typedef struct {
     int pos_y;  /**< Y position */
 } qui_Rect;
 
+/** @brief Kind of queued input event */
+typedef enum {
+    QUI_EVENT_MOVE = 0, /**< Mouse moved to x, y */
+    QUI_EVENT_BUTTON,   /**< Mouse button changed at x, y (value 1 = down, 0 = up) */
+    QUI_EVENT_WHEEL,    /**< Mouse wheel turned by wheel notches */
+    QUI_EVENT_KEY,      /**< Key pressed (value is a qui_Key) */
+    QUI_EVENT_TEXT      /**< Character typed (value is a Unicode code point) */
+} qui_EventType;
+
+/** @brief Keys the widgets react to */
+typedef enum {
+    QUI_KEY_BACKSPACE = 0, /**< Delete the character before the caret */
+    QUI_KEY_ENTER,         /**< Confirm input */
+    QUI_KEY_DELETE,        /**< Delete the character after the caret */
+    QUI_KEY_LEFT,          /**< Move the caret one character left */
+    QUI_KEY_RIGHT,         /**< Move the caret one character right */
+    QUI_KEY_HOME,          /**< Move the caret to the start */
+    QUI_KEY_END,           /**< Move the caret to the end */
+    QUI_KEY_SELECT_ALL,    /**< Select everything */
+    QUI_KEY_UP,            /**< Move the caret one line up (multi-line widgets) */
+    QUI_KEY_DOWN,          /**< Move the caret one line down (multi-line widgets) */
+    QUI_KEY_PAGE_UP,       /**< Move the caret one page up (multi-line widgets) */
+    QUI_KEY_PAGE_DOWN      /**< Move the caret one page down (multi-line widgets) */
+} qui_Key;
+
+/** @brief Modifier bit for qui_feed_key(): extend the selection while moving the caret */
+#define QUI_KEY_SHIFT 0x100
+
+/** @brief Timestamped input event */
+typedef struct {
+    qui_EventType type; /**< Event kind */
+    int x;              /**< Mouse X (move, button) */
+    int y;              /**< Mouse Y (move, button) */
+    int value;          /**< Button state, qui_Key or code point */
+    float wheel;        /**< Wheel notches, positive when scrolling up */
+    uint64_t time_ns;   /**< qui_time_ns() when the event happened */
+} qui_InputEvent;
+
+/** @brief Clip rectangle as edges in screen coordinates */
+typedef struct {
+    float x0; /**< Left edge */
+    float y0; /**< Top edge */
+    float x1; /**< Right edge (exclusive) */
+    float y1; /**< Bottom edge (exclusive) */
+} qui_ClipRect;
+
 /** @brief Default color scheme */
 typedef enum {
     QUI_COLOR_BACKGROUND = 0, /**< Default background color */
@@ -157,9 +348,444 @@ typedef enum {
     QUI_COLOR_TEXT,           /**< Text color */
     QUI_COLOR_WINDOW_BG,      /**< Window background color */
     QUI_COLOR_TITLE_BAR,      /**< Window title bar color */
+    QUI_COLOR_SELECTION,      /**< Selected text background */
     QUI_COLOR_COUNT           /**< Number of color types */
 } qui_ColorType;
 
+/** @brief Glyph bitmap in a font atlas */
+typedef struct {
+    uint16_t x;       /**< Left edge in the atlas */
+    uint16_t y;       /**< Top edge in the atlas */
+    uint16_t width;   /**< Bitmap width (0 for blank glyphs such as space) */
+    uint16_t height;  /**< Bitmap height */
+    float offset_x;   /**< Bitmap offset from the pen position */
+    float offset_y;   /**< Bitmap offset from the top of the line */
+    float advance;    /**< Pen advance */
+    int defined;      /**< Glyph was added to the font */
+} qui_Glyph;
+
+/** @brief Horizontal segment of the packed skyline */
+typedef struct {
+    int x;     /**< Left edge */
+    int y;     /**< Height of the skyline over the segment */
+    int width; /**< Segment width */
+} qui_SkylineNode;
+
+/** @brief Skyline bottom-left rectangle packer */
+typedef struct {
+    qui_SkylineNode nodes[QUI_SKYLINE_MAX_NODES]; /**< Segments, left to right */
+    int count;  /**< Segments in use */
+    int width;  /**< Packing area width */
+    int height; /**< Packing area height */
+} qui_Skyline;
+
+/**
+ * @brief Bitmap font packed into a single-channel atlas
+ * 
+ * Pixels hold glyph coverage (0-255). One opaque texel is reserved so solid rects can
+ * use the same texture and batch with text.
+ */
+typedef struct {
+    unsigned char *pixels;  /**< Atlas coverage, atlas_width * atlas_height bytes (owned) */
+    int atlas_width;        /**< Atlas width in pixels */
+    int atlas_height;       /**< Atlas height in pixels */
+    qui_Image image;        /**< Atlas texture handle for batches (data defaults to pixels) */
+    qui_Skyline packer;     /**< Free space in the atlas */
+    qui_Glyph glyphs[QUI_FONT_GLYPH_COUNT]; /**< Glyphs by code point */
+    uint32_t fallback;      /**< Code point drawn for missing glyphs */
+    float line_height;      /**< Text height */
+    float white_u;          /**< U of the opaque texel */
+    float white_v;          /**< V of the opaque texel */
+} qui_Font;
+
+/**
+ * @brief RGBA pages that many small images are packed into
+ * 
+ * Every page keeps an opaque 2x2 block at its top-left corner so solid rects can
+ * batch with the images on it.
+ */
+typedef struct {
+    qui_Image pages[QUI_IMAGE_ATLAS_MAX_PAGES];     /**< Page textures, 4 channels (pixels owned) */
+    qui_Skyline packers[QUI_IMAGE_ATLAS_MAX_PAGES]; /**< Free space per page */
+    int page_count;  /**< Pages in use */
+    int page_width;  /**< Page width in pixels */
+    int page_height; /**< Page height in pixels */
+} qui_ImageAtlas;
+
+/** @brief Draw command types recorded into a draw list */
+typedef enum {
+    QUI_COMMAND_RECT = 0, /**< Filled rectangle */
+    QUI_COMMAND_TEXT,     /**< Text string */
+    QUI_COMMAND_IMAGE,    /**< Image */
+    QUI_COMMAND_CLIP      /**< Scissor change for the commands that follow (w < 0: no scissor) */
+} qui_CommandType;
+
+/** @brief Single recorded draw command (absolute screen coordinates) */
+typedef struct {
+    qui_CommandType type; /**< Command type */
+    float x;              /**< X position */
+    float y;              /**< Y position */
+    float w;              /**< Width (rects, images and clips) */
+    float h;              /**< Height (rects, images and clips) */
+    qui_Color32 color;    /**< Fill color (rects) or text color (text) */
+    const char *text;     /**< Text string in the frame arena (text) */
+    qui_Image *image;     /**< Image handle (images) */
+} qui_DrawCmd;
+
+/** @brief Contiguous list of draw commands recorded during one frame */
+typedef struct {
+    qui_DrawCmd *commands; /**< Command array */
+    int count;             /**< Number of recorded commands */
+    int capacity;          /**< Maximum number of commands */
+    int dropped;           /**< Commands dropped this frame because storage was full */
+    qui_Font *font;        /**< Atlas font the text was measured with (qui_use_font), or NULL */
+} qui_DrawList;
+
+/** @brief Interleaved vertex for batched renderers */
+typedef struct {
+    float x;        /**< X position */
+    float y;        /**< Y position */
+    float u;        /**< Texture U coordinate */
+    float v;        /**< Texture V coordinate */
+    qui_Color32 color; /**< Packed RGBA8 color */
+} qui_Vertex;
+
+/** @brief Range of indices sharing one texture */
+typedef struct {
+    qui_Image *texture;         /**< Texture for the batch, NULL for solid geometry */
+    const qui_DrawCmd *command; /**< Command the backend must handle itself (text, clip), else NULL */
+    uint32_t vertex_offset;     /**< First vertex of the batch; indices are relative to it */
+    uint32_t index_offset;      /**< First index of the batch */
+    uint32_t index_count;       /**< Number of indices in the batch */
+} qui_DrawBatch;
+
+/** @brief Vertex, index and batch buffers for a whole frame */
+typedef struct {
+    qui_Vertex *vertices;   /**< Vertex array */
+    int vertex_count;       /**< Vertices in use */
+    int vertex_capacity;    /**< Vertex array capacity */
+    void *indices;          /**< Index array (uint16_t or uint32_t) */
+    int index_count;        /**< Indices in use */
+    int index_capacity;     /**< Index array capacity */
+    int index_size;         /**< Size of one index in bytes (2 or 4) */
+    qui_DrawBatch *batches; /**< Batch array */
+    int batch_count;        /**< Batches in use */
+    int batch_capacity;     /**< Batch array capacity */
+    int dropped;            /**< Commands that did not fit */
+} qui_VertexBuffer;
+
+/** @brief Cached measurement of one string */
+typedef struct {
+    uint64_t key;       /**< Hash of text and font settings (0 = empty slot) */
+    uint32_t length;    /**< Text length in bytes */
+    uint32_t last_used; /**< Cache tick of the last lookup (LRU eviction) */
+    uint32_t flags;     /**< Which of width/height are valid */
+    float width;        /**< Cached text width */
+    float height;       /**< Cached text height */
+} qui_TextCacheEntry;
+
+/** @brief Bounded, 4-way set associative cache of text measurements */
+typedef struct {
+    qui_TextCacheEntry entries[QUI_TEXT_CACHE_SIZE]; /**< Cache slots */
+    uint32_t tick;      /**< Lookup counter used as LRU clock */
+    uint64_t hits;      /**< Measurements answered from the cache */
+    uint64_t misses;    /**< Measurements that called the backend */
+    uint64_t evictions; /**< Valid entries replaced by new strings */
+} qui_TextCache;
+
+/** @brief Slot of the per-frame duplicate ID check */
+typedef struct {
+    qui_Id id;      /**< Widget ID */
+    uint32_t frame; /**< Frame the slot was filled in (any other frame = empty) */
+} qui_IdSlot;
+
+/** @brief Slot of the widget state hash map */
+typedef struct {
+    qui_Id id;           /**< Widget ID (0 = empty slot) */
+    uint32_t last_frame; /**< Frame the state was last used */
+    uint32_t block;      /**< Index of the state block in the pool */
+} qui_StateSlot;
+
+/** @brief Open-addressing map from widget ID to pooled fixed-size state blocks */
+typedef struct {
+    qui_StateSlot *slots;     /**< Linear probing table */
+    uint32_t slot_capacity;   /**< Table size (power of two) */
+    uint32_t live;            /**< Slots in use */
+    unsigned char **chunks;   /**< Block pool, allocated in chunks that never move */
+    uint32_t chunk_count;     /**< Number of allocated chunks */
+    uint32_t block_count;     /**< Blocks carved from the chunks so far */
+    uint32_t free_block;      /**< Head of the free block list (UINT32_MAX = empty) */
+    uint32_t max_age;         /**< Frames a state survives without being used */
+    uint32_t sweep_cursor;    /**< Next slot checked by the incremental collector */
+} qui_StateStore;
+
+/** @brief Header in front of every frame arena block */
+typedef struct qui_ArenaBlock {
+    struct qui_ArenaBlock *prev; /**< Block filled earlier this frame */
+    size_t used;                 /**< Bytes handed out from the block once it is full */
+} qui_ArenaBlock;
+
+/** @brief Linear allocator reset at the start of every frame */
+typedef struct {
+    qui_ArenaBlock *block; /**< Current block, chained to the ones it replaced this frame */
+    unsigned char *base;   /**< Memory of the current block */
+    size_t capacity;       /**< Size of the current block in bytes */
+    size_t used;           /**< Bytes handed out from the current block */
+    size_t spilled;        /**< Bytes handed out from earlier blocks this frame */
+    size_t high_water;     /**< Largest number of bytes used in any frame */
+    uint32_t failures;     /**< Allocations that failed this frame (out of memory) */
+} qui_Arena;
+
+/** @brief Bounds and content hash of everything one widget drew in a frame */
+typedef struct {
+    qui_Id id;     /**< Widget ID (0 for primitives outside any widget) */
+    uint64_t hash; /**< Hash of the widget's primitives */
+    float x0;      /**< Left edge of the drawn bounds */
+    float y0;      /**< Top edge of the drawn bounds */
+    float x1;      /**< Right edge of the drawn bounds */
+    float y1;      /**< Bottom edge of the drawn bounds */
+} qui_WidgetRecord;
+
+/** @brief Per-widget comparison of this frame's output against the previous frame */
+typedef struct {
+    bool enabled;                 /**< Damage tracking on */
+    qui_WidgetRecord *records;    /**< Records of the current frame */
+    int count;                    /**< Records in use */
+    int capacity;                 /**< Record array capacity */
+    qui_WidgetRecord *previous;   /**< Records of the previous frame */
+    int previous_count;           /**< Previous records in use */
+    int previous_capacity;        /**< Previous record array capacity */
+    qui_Rect rects[QUI_MAX_DAMAGE_RECTS]; /**< Regions that changed, screen coordinates */
+    int rect_count;               /**< Number of damage rectangles */
+} qui_DamageTracker;
+
+/** @brief How a layout column gets its width */
+typedef enum {
+    QUI_SIZE_AUTO = 0, /**< Width of the widest widget in the column (measured, cached across frames) */
+    QUI_SIZE_FIXED,    /**< Fixed width in pixels */
+    QUI_SIZE_PERCENT,  /**< Percentage of the row width */
+    QUI_SIZE_FLEX      /**< Share of the width left over, weighted */
+} qui_SizeMode;
+
+/** @brief Column width specification */
+typedef struct {
+    qui_SizeMode mode; /**< Sizing mode */
+    float value;       /**< Pixels, percent or flex weight depending on mode */
+} qui_Size;
+
+/** @brief Alignment of a widget inside its layout cell */
+typedef enum {
+    QUI_ALIGN_START = 0, /**< Left or top */
+    QUI_ALIGN_CENTER,    /**< Centered */
+    QUI_ALIGN_END        /**< Right or bottom */
+} qui_Align;
+
+/** @brief Active row/grid layout: widgets fill cells left to right and wrap after the last column */
+typedef struct {
+    bool active;                               /**< Widgets are placed in cells */
+    qui_Id id;                                 /**< Row ID, keys the cached measurements */
+    int columns;                               /**< Number of columns */
+    qui_Size sizes[QUI_LAYOUT_MAX_COLUMNS];    /**< Column specifications */
+    float widths[QUI_LAYOUT_MAX_COLUMNS];      /**< Resolved column widths */
+    float measured[QUI_LAYOUT_MAX_COLUMNS];    /**< Widest widget per column this frame */
+    float measured_height;                     /**< Tallest row this frame */
+    float row_height;                          /**< Height of the current row so far */
+    float cached_height;                       /**< Tallest row last frame (vertical alignment) */
+    int column;                                /**< Next cell in the current row */
+    float x;                                   /**< Left edge of the rows */
+    float y;                                   /**< Top edge of the current row */
+    float cell_x;                              /**< Left edge of the next cell */
+    qui_Align align_x;                         /**< Horizontal alignment in cells */
+    qui_Align align_y;                         /**< Vertical alignment in rows */
+} qui_RowLayout;
+
+/** @brief Layout state saved when a window or scroll region opens */
+typedef struct {
+    float cursor_x;      /**< Outer layout cursor X */
+    float cursor_y;      /**< Outer layout cursor Y */
+    float offset_x;      /**< Outer layout offset X */
+    float offset_y;      /**< Outer layout offset Y */
+    float start_x;       /**< Outer column left edge */
+    float content_width; /**< Outer available width */
+    qui_Id window;       /**< Window the outer layout belongs to (0 = none) */
+    qui_RowLayout row;   /**< Outer row layout */
+} qui_LayoutFrame;
+
+/** @brief Open scroll region */
+typedef struct {
+    qui_Id id;   /**< Region ID */
+    void *state; /**< Persistent scroll state in the state store */
+    float x;     /**< Region left edge, screen coordinates */
+    float y;     /**< Region top edge, screen coordinates */
+    float w;     /**< Region width */
+    float h;     /**< Region height */
+} qui_ScrollFrame;
+
+/** @brief Window known to the context, kept in back-to-front order */
+typedef struct {
+    qui_Id id;           /**< Window ID */
+    float x;             /**< Left edge when last shown */
+    float y;             /**< Top edge when last shown */
+    float w;             /**< Width when last shown */
+    float h;             /**< Height when last shown */
+    uint32_t last_frame; /**< Frame the window was last shown */
+} qui_WindowEntry;
+
+/** @brief Hit rectangle of one widget, recorded while the frame is built */
+typedef struct {
+    qui_Id id;     /**< Widget ID */
+    qui_Id window; /**< Window the widget belongs to (0 = none) */
+    float x0;      /**< Left edge, screen coordinates */
+    float y0;      /**< Top edge */
+    float x1;      /**< Right edge */
+    float y1;      /**< Bottom edge */
+} qui_HitRecord;
+
+/**
+ * @brief Uniform grid over the previous frame's hit rectangles
+ * 
+ * Cells index into flat entry arrays (CSR layout). Entries store their rectangle
+ * as separate coordinate arrays so a cell can be tested several boxes at a time.
+ */
+typedef struct {
+    qui_HitRecord *records; /**< Rectangles recorded this frame */
+    int count;              /**< Records in use */
+    int capacity;           /**< Record array capacity */
+    int cols;               /**< Grid columns (0 = empty grid) */
+    int rows;               /**< Grid rows */
+    float origin_x;         /**< Left edge of the grid */
+    float origin_y;         /**< Top edge of the grid */
+    float inv_cell_w;       /**< 1 / cell width */
+    float inv_cell_h;       /**< 1 / cell height */
+    int *cell_start;        /**< cols * rows + 1 offsets into the entry arrays */
+    int cell_capacity;      /**< cell_start capacity */
+    float *x0;              /**< Entry left edges */
+    float *y0;              /**< Entry top edges */
+    float *x1;              /**< Entry right edges */
+    float *y1;              /**< Entry bottom edges */
+    uint64_t *order;        /**< Entry stacking order (higher is on top) */
+    qui_Id *ids;            /**< Entry widget IDs */
+    int entry_count;        /**< Entries in use */
+    int entry_capacity;     /**< Entry array capacity */
+} qui_HitIndex;
+
+/**
+ * @brief Counters for one frame, filled between qui_begin() and qui_end()
+ * 
+ * Only collected when QUI_STATS is defined before including the implementation;
+ * otherwise the counters compile away and stay zero.
+ */
+typedef struct {
+    uint32_t widgets;               /**< Widget IDs generated */
+    uint32_t widgets_culled;        /**< Widgets skipped because they were clipped away */
+    uint32_t draw_rect_calls;       /**< Rectangles passed to draw_rect or recorded */
+    uint32_t draw_text_calls;       /**< Strings passed to draw_text or recorded */
+    uint32_t draw_image_calls;      /**< Images passed to draw_image or recorded */
+    uint32_t set_clip_calls;        /**< Scissor changes passed to set_clip or recorded */
+    uint32_t text_measures_cached;  /**< Text measurements answered by the text cache */
+    uint32_t text_measures_uncached;/**< Text measurements that called text_width/text_height */
+    uint32_t hit_tests;             /**< Widget rectangles tested against the mouse */
+    uint32_t hit_queries;           /**< Point queries against the hit grid */
+    uint32_t input_events;          /**< Queued input events applied */
+    uint64_t input_latency_ns;      /**< Oldest applied input event to qui_end() */
+    size_t arena_bytes;             /**< Frame arena bytes used */
+    size_t draw_list_bytes;         /**< Draw list bytes used */
+    size_t hit_bytes;               /**< Hit rectangle bytes recorded */
+    uint64_t frame_ns;              /**< Time from qui_begin() to qui_end() in nanoseconds */
+} qui_Stats;
+
+/** @brief What a trace event measured */
+typedef enum {
+    QUI_TRACE_FRAME = 0, /**< qui_begin() to qui_end() */
+    QUI_TRACE_WINDOW,    /**< qui_begin_window() to qui_end_window() */
+    QUI_TRACE_USER,      /**< qui_trace_begin() to qui_trace_end() */
+    QUI_TRACE_BACKEND    /**< One rendering or measuring callback */
+} qui_TraceCategory;
+
+/** @brief Completed scope in the trace ring buffer */
+typedef struct {
+    char name[QUI_TRACE_NAME_SIZE]; /**< Scope name (truncated) */
+    uint64_t start_ns;              /**< qui_time_ns() when the scope began */
+    uint64_t duration_ns;           /**< Scope length */
+    uint32_t category;              /**< qui_TraceCategory */
+} qui_TraceEvent;
+
+/** @brief Scope that has begun but not yet ended */
+typedef struct {
+    const char *name;  /**< Scope name (must stay valid until the scope ends) */
+    uint64_t start_ns; /**< qui_time_ns() when the scope began */
+    uint32_t category; /**< qui_TraceCategory */
+} qui_TraceScope;
+
+/**
+ * @brief Ring buffer of completed trace scopes
+ * 
+ * Scopes are written when they end, so the buffer never holds half a scope.
+ * When it is full the oldest events are overwritten.
+ */
+typedef struct {
+    qui_TraceEvent *events;   /**< Ring storage (NULL = tracing off) */
+    uint32_t capacity;        /**< Number of events (power of two) */
+    uint64_t written;         /**< Events ever written */
+    uint64_t flushed;         /**< Events already written out or dropped */
+    qui_TraceScope stack[QUI_TRACE_STACK_SIZE]; /**< Open scopes */
+    int depth;                /**< Open scopes (may exceed the stack; deeper ones are not recorded) */
+} qui_Trace;
+
+/** @brief Run of draw list commands that belong to one window */
+typedef struct {
+    qui_Id window; /**< Owning window (0 = outside any window) */
+    int start;     /**< First command */
+    int end;       /**< One past the last command */
+} qui_DrawSegment;
+
+/**
+ * @brief Visible index range of a long list inside a clip region
+ * 
+ * Rows are either all item_height tall, or row i spans offsets[i] to offsets[i + 1].
+ */
+typedef struct {
+    int item_count;       /**< Number of rows */
+    float item_height;    /**< Row advance for fixed-height rows */
+    const float *offsets; /**< item_count + 1 row start offsets for variable-height rows, or NULL */
+    float start_y;        /**< Layout cursor Y where the list starts */
+    int display_start;    /**< First row to draw */
+    int display_end;      /**< One past the last row to draw */
+} qui_ListClipper;
+
+/** @brief Run of a qui_TextDoc: length bytes from the original or the added text */
+typedef struct {
+    size_t start;      /**< Offset into the source buffer */
+    size_t length;     /**< Bytes in the run */
+    size_t newlines;   /**< '\n' bytes in the run */
+    int added;         /**< 0 = original text, 1 = added text */
+} qui_TextPiece;
+
+/**
+ * @brief Editable text stored as a piece table
+ * 
+ * The original text is referenced, not copied; insertions are appended to a growing
+ * add buffer and the document is the sequence of pieces. Both buffers keep a sorted
+ * index of their '\n' offsets, so line lookups are binary searches per piece.
+ */
+typedef struct {
+    const char *original;       /**< Text the document was opened with (must outlive the document) */
+    size_t original_length;     /**< Bytes in original */
+    size_t *original_lines;     /**< Offsets of the '\n' bytes in original */
+    size_t original_line_count; /**< Entries in original_lines */
+    char *added;                /**< Inserted text, append only */
+    size_t added_length;        /**< Bytes used in added */
+    size_t added_capacity;      /**< Bytes allocated for added */
+    size_t *added_lines;        /**< Offsets of the '\n' bytes in added */
+    size_t added_line_count;    /**< Entries in added_lines */
+    size_t added_line_capacity; /**< Entries allocated for added_lines */
+    qui_TextPiece *pieces;      /**< Document order */
+    int piece_count;            /**< Pieces in use */
+    int piece_capacity;         /**< Pieces allocated */
+    size_t length;              /**< Document length in bytes */
+    size_t line_count;          /**< Lines in the document ('\n' count + 1) */
+} qui_TextDoc;
+
 /* ================================================================================================
  * MAIN CONTEXT STRUCTURE
  * ================================================================================================ */
@@ -176,6 +802,15 @@ typedef struct qui_Context {
     qui_Id hot_id;           /**< Element under mouse cursor */
     qui_Id keyboard_focus_id; /**< Element with keyboard focus */
     qui_Id last_id;          /**< Last generated ID */
+    uint32_t frame_index;    /**< Number of frames begun so far */
+    
+    /* ID scopes */
+    qui_Id id_stack[QUI_ID_STACK_SIZE]; /**< Seeds pushed with qui_push_id() */
+    int id_stack_depth;      /**< Number of pushed ID scopes */
+    qui_IdSlot *id_seen;     /**< IDs generated this frame, linear probing (debug builds) */
+    uint32_t id_seen_capacity; /**< id_seen size (power of two) */
+    uint32_t id_seen_count;  /**< id_seen slots filled this frame */
+    uint32_t id_collisions;  /**< Duplicate IDs detected (debug builds) */
 
     /* Input state */
     qui_Vec2 mouse_pos;      /**< Current mouse position */
@@ -185,9 +820,33 @@ typedef struct qui_Context {
     int key_pressed;         /**< Key pressed state */
     int key_backspace;       /**< Backspace key pressed */
     int key_enter;           /**< Enter key pressed */
+    float mouse_wheel;       /**< Wheel notches this frame (positive scrolls up) */
+    char text_input[QUI_TEXT_INPUT_SIZE]; /**< UTF-8 text typed this frame */
+    int text_input_length;   /**< Bytes in text_input */
+    int keys[QUI_MAX_FRAME_KEYS];        /**< Keys pressed this frame (qui_Key | QUI_KEY_SHIFT) */
+    int key_text_offset[QUI_MAX_FRAME_KEYS]; /**< Bytes of text_input typed before each key */
+    int key_count;           /**< Keys in keys[] */
+
+    /* Queued input, applied in order by qui_begin() */
+    qui_InputEvent input_queue[QUI_INPUT_QUEUE_SIZE]; /**< Ring of pending events */
+    uint32_t input_head;     /**< Next event to apply */
+    uint32_t input_tail;     /**< Next free slot */
+    uint32_t input_dropped;  /**< Events lost because the queue was full */
+    qui_Vec2 input_pos;      /**< Mouse position after the last queued event */
+    uint64_t input_time_ns;  /**< Time of the oldest event applied this frame (0 = none) */
+
+    /* Redraw tracking */
+    bool redraw_requested;   /**< Input or style changed since the last frame began */
+    int redraw_frames;       /**< Frames left before the UI counts as idle */
+    uint64_t frame_hash;     /**< Hash of everything drawn this frame */
+    uint64_t last_frame_hash;/**< Hash of everything drawn last frame */
+    qui_Id last_hot_id;      /**< hot_id at the end of last frame */
+    qui_Id last_active_id;   /**< active_id at the end of last frame */
+    qui_Id last_focus_id;    /**< keyboard_focus_id at the end of last frame */
+    qui_DamageTracker damage; /**< Changed regions since last frame */
 
     /* Color scheme */
-    qui_Color colors[QUI_COLOR_COUNT]; /**< Default color palette */
+    qui_Color32 colors[QUI_COLOR_COUNT]; /**< Color palette, packed (qui_set_color/qui_get_color) */
 
     /* Layout state */
     float cursor_x;          /**< Current layout cursor X */
@@ -196,29 +855,69 @@ typedef struct qui_Context {
     float spacing_y;         /**< Vertical spacing between elements */
     float layout_offset_x;   /**< Layout X offset (for windows) */
     float layout_offset_y;   /**< Layout Y offset (for windows) */
+    float layout_start_x;    /**< Left edge widgets return to after each row */
+    float content_width;     /**< Width available to rows (0 = unknown) */
+    qui_RowLayout row;       /**< Current row/grid layout */
+    uint32_t layout_serial;  /**< Rows begun this frame (row IDs) */
+    
+    /* Clipping */
+    qui_ClipRect clip;       /**< Current clip rectangle, screen coordinates */
+    qui_ClipRect clip_stack[QUI_CLIP_STACK_SIZE]; /**< Clip rectangles saved by qui_push_clip() */
+    int clip_depth;          /**< Number of pushed clip regions */
+    qui_ClipRect backend_clip; /**< Scissor last sent to the backend */
+    bool backend_clip_set;   /**< A scissor is active in the backend */
+    
+    /* Scroll regions */
+    qui_ScrollFrame scroll_stack[QUI_SCROLL_STACK_SIZE]; /**< Open scroll regions */
+    int scroll_depth;        /**< Number of open scroll regions */
     
     /* Saved layout state (for nested contexts) */
-    float saved_cursor_x;    /**< Saved cursor X position */
-    float saved_cursor_y;    /**< Saved cursor Y position */
-    float saved_offset_x;    /**< Saved offset X position */
-    float saved_offset_y;    /**< Saved offset Y position */
+    qui_LayoutFrame layout_stack[QUI_LAYOUT_STACK_SIZE]; /**< Outer layouts of open scopes */
+    int layout_depth;        /**< Number of open layout scopes */
+    
+    /* Windows */
+    qui_WindowEntry windows[QUI_MAX_WINDOWS]; /**< Known windows, back to front */
+    int window_count;        /**< Number of known windows */
+    qui_Id current_window;   /**< Window being built (0 = none) */
+    qui_Id hover_window;     /**< Topmost window under the mouse last frame (0 = none) */
+    qui_Id hover_id;         /**< Topmost widget under the mouse in last frame's layout */
+    qui_HitIndex hit_index;  /**< Widget rectangles for hover queries */
+    qui_DrawSegment draw_segments[QUI_MAX_WINDOWS * 4]; /**< Per-window command runs this frame */
+    int segment_count;       /**< Closed segments */
+    int segment_start;       /**< First command of the open segment */
+    bool segments_overflow;  /**< Too many segments to reorder this frame */
 
-    /* Drag support */
-    float drag_offset_x;     /**< Drag X offset */
-    float drag_offset_y;     /**< Drag Y offset */
+    /* Per-widget persistent state */
+    qui_StateStore state;    /**< Widget state blocks keyed by ID */
+    
+    /* Transient per-frame memory */
+    qui_Arena frame_arena;   /**< Scratch memory reset by qui_begin() */
 
     /* Font properties */
     void *font;              /**< Font handle (backend-specific) */
+    qui_Font *atlas_font;    /**< Built-in text path (qui_use_font), NULL = text callbacks */
+    const float *advance_table; /**< 256 per-byte advances (qui_set_font_advances), or NULL */
     float font_size;         /**< Font size */
     float font_spacing;      /**< Font character spacing */
+    qui_TextCache text_cache; /**< Measurements from text_width/text_height */
 
     /* Window/popup state */
     bool popup_open;         /**< Popup window open state */
     qui_Vec2 popup_pos;      /**< Popup position */
     qui_Vec2 popup_size;     /**< Popup size */
 
+    /* Draw command recording */
+    qui_DrawList draw_list;  /**< Commands recorded this frame */
+    bool draw_list_enabled;  /**< Record commands instead of calling callbacks */
+
+    /* Frame statistics (QUI_STATS builds) */
+    qui_Stats stats;         /**< Counters for the current or last frame */
+    uint64_t frame_start_ns; /**< qui_time_ns() at qui_begin() */
+    qui_Trace trace;         /**< Timeline of scoped regions (QUI_TRACE builds) */
+
     /* User data */
     void *userdata;          /**< User-defined data pointer */
+    void *render_target;     /**< Backend render target (used by built-in renderers) */
 
     /* Rendering callbacks (must be set by user) */
     
@@ -246,6 +945,14 @@ typedef struct qui_Context {
      */
     float (*text_height)(struct qui_Context* ctx, const char *text);
     
+    /** @brief Kerning between two adjacent bytes, used with the advance table (optional)
+     * @param ctx QuickUI context
+     * @param left First byte
+     * @param right Following byte
+     * @return Adjustment added to the advance of left
+     */
+    float (*kerning)(struct qui_Context* ctx, unsigned char left, unsigned char right);
+    
     /** @brief Draw an image
      * @param ctx QuickUI context
      * @param img Image to draw
@@ -255,6 +962,16 @@ typedef struct qui_Context {
      * @param h Height to draw
      */
     void (*draw_image)(struct qui_Context* ctx, qui_Image *img, float x, float y, float w, float h);
+    
+    /** @brief Restrict the following draw calls to a rectangle (optional)
+     * 
+     * Only called for text and images that cross the edge of a clip region;
+     * rectangles are clipped before they reach the backend.
+     * 
+     * @param ctx QuickUI context
+     * @param clip Scissor rectangle in screen coordinates, NULL to disable scissoring
+     */
+    void (*set_clip)(struct qui_Context* ctx, const qui_Rect *clip);
 } qui_Context;
 
 /* ================================================================================================
@@ -263,6 +980,10 @@ typedef struct qui_Context {
 
 /**
  * @brief Initialize QuickUI context with default values
+ * 
+ * Allocates the per-frame arena (QUI_FRAME_ARENA_SIZE bytes). Call qui_cleanup()
+ * to release it.
+ * 
  * @param ctx Pointer to context structure (must not be NULL)
  * @param user_data Optional user data pointer
  * @return QUI_OK on success, error code on failure
@@ -292,6 +1013,53 @@ qui_Result qui_begin(qui_Context *ctx, float start_x, float start_y);
  */
 qui_Result qui_end(qui_Context *ctx);
 
+/**
+ * @brief Check whether the host should run another frame
+ * 
+ * Call after qui_end(). Returns false once input has stopped, the drawn output has not
+ * changed for QUI_SETTLE_FRAMES frames and no redraw was requested; the host can then
+ * block on input instead of rendering.
+ * 
+ * @param ctx Context pointer
+ * @return true if a frame is needed
+ */
+bool qui_needs_redraw(const qui_Context *ctx);
+
+/**
+ * @brief Get the number of frames left before the UI is idle without further input
+ * @param ctx Context pointer
+ * @return Frames until idle, 0 if already idle
+ */
+int qui_frames_until_idle(const qui_Context *ctx);
+
+/**
+ * @brief Ask for another frame (e.g. while an animation is running)
+ * @param ctx Context pointer (must not be NULL)
+ * @return QUI_OK on success, error code on failure
+ */
+qui_Result qui_request_redraw(qui_Context *ctx);
+
+/**
+ * @brief Turn per-widget damage tracking on or off
+ * 
+ * While enabled, every widget's primitives are hashed and bounded, and qui_end()
+ * compares them with the previous frame by widget ID to produce a short list of
+ * rectangles that need repainting.
+ * 
+ * @param ctx Context pointer (must not be NULL)
+ * @param enabled true to track damage
+ * @return QUI_OK on success, error code on failure
+ */
+qui_Result qui_enable_damage_tracking(qui_Context *ctx, bool enabled);
+
+/**
+ * @brief Get the regions that changed between the last two frames
+ * @param ctx Context pointer
+ * @param count Output number of rectangles (must not be NULL)
+ * @return Array of damage rectangles in screen coordinates, NULL if none
+ */
+const qui_Rect* qui_get_damage_rects(const qui_Context *ctx, int *count);
+
 /**
  * @brief Get error string for result code
  * @param result Result code
@@ -330,6 +1098,14 @@ qui_Result qui_mouse_up(qui_Context *ctx, int x, int y);
  */
 qui_Result qui_mouse_move(qui_Context *ctx, int x, int y);
 
+/**
+ * @brief Handle mouse wheel movement
+ * @param ctx Context pointer (must not be NULL)
+ * @param delta Wheel notches, positive when scrolling up
+ * @return QUI_OK on success, error code on failure
+ */
+qui_Result qui_mouse_wheel(qui_Context *ctx, float delta);
+
 /**
  * @brief Handle generic mouse button state
  * @param ctx Context pointer (must not be NULL)
@@ -352,6 +1128,50 @@ qui_Result qui_feed_key_backspace(qui_Context *ctx);
  */
 qui_Result qui_feed_key_enter(qui_Context *ctx);
 
+/**
+ * @brief Handle a typed character
+ * @param ctx Context pointer (must not be NULL)
+ * @param codepoint Unicode code point (control characters are ignored)
+ * @return QUI_OK on success, error code on failure
+ */
+qui_Result qui_feed_char(qui_Context *ctx, uint32_t codepoint);
+
+/**
+ * @brief Handle typed text
+ * 
+ * Queues one character per code point. Invalid UTF-8 bytes and control characters
+ * are skipped. The text is queued completely or not at all.
+ * 
+ * @param ctx Context pointer (must not be NULL)
+ * @param utf8 NUL-terminated UTF-8 text (must not be NULL)
+ * @return QUI_OK on success, QUI_ERROR_BUFFER_TOO_SMALL if the input queue cannot hold
+ *         all of it (nothing is queued; see QUI_INPUT_QUEUE_SIZE)
+ */
+qui_Result qui_feed_text(qui_Context *ctx, const char *utf8);
+
+/**
+ * @brief Handle an editing or navigation key
+ * @param ctx Context pointer (must not be NULL)
+ * @param key qui_Key, optionally combined with QUI_KEY_SHIFT
+ * @return QUI_OK on success, error code on failure
+ */
+qui_Result qui_feed_key(qui_Context *ctx, int key);
+
+/**
+ * @brief Queue an input event
+ * 
+ * All input functions above queue events; they are applied in order at the next
+ * qui_begin(). Consecutive moves are merged. A button change ends the events applied
+ * in one frame, so a press and release that arrive together are seen in two
+ * frames and no click is lost; qui_needs_redraw() stays true until the queue is
+ * empty. Use this directly to pass the platform's own event timestamps.
+ * 
+ * @param ctx Context pointer (must not be NULL)
+ * @param event Event to queue (time_ns 0 = now) (must not be NULL)
+ * @return QUI_OK on success, QUI_ERROR_BUFFER_TOO_SMALL if the queue is full
+ */
+qui_Result qui_push_event(qui_Context *ctx, const qui_InputEvent *event);
+
 /* ================================================================================================
  * UTILITY FUNCTIONS
  * ================================================================================================ */
@@ -374,6 +1194,16 @@ qui_Vec2 qui_vec2(int x, int y);
  */
 qui_Rect qui_rect(int width, int height, int pos_x, int pos_y);
 
+/**
+ * @brief Create a standalone image (not in an atlas page)
+ * @param data Pixel data, or a backend texture handle
+ * @param width Image width in pixels
+ * @param height Image height in pixels
+ * @param channels Number of color channels (1-4)
+ * @return qui_Image structure
+ */
+qui_Image qui_image(void *data, int width, int height, int channels);
+
 /**
  * @brief Create an RGBA color
  * @param r Red component (0-255)
@@ -384,6 +1214,20 @@ qui_Rect qui_rect(int width, int height, int pos_x, int pos_y);
  */
 qui_Color qui_color(int r, int g, int b, int a);
 
+/**
+ * @brief Pack a color into 32 bits with R in the lowest byte (RGBA8 byte order)
+ * @param color Color to pack
+ * @return Packed color
+ */
+qui_Color32 qui_pack_color(qui_Color color);
+
+/**
+ * @brief Unpack a packed color
+ * @param color Packed color
+ * @return Color with components 0-255
+ */
+qui_Color qui_unpack_color(qui_Color32 color);
+
 /**
  * @brief Set color in context color scheme
  * @param ctx Context pointer (must not be NULL)
@@ -412,29 +1256,485 @@ qui_Result qui_get_color(qui_Context *ctx, qui_ColorType type, qui_Color *color)
  */
 qui_Result qui_set_font(qui_Context *ctx, void *font, float font_size, float font_spacing);
 
-/* ================================================================================================
- * UI ELEMENTS
- * ================================================================================================ */
-
 /**
- * @brief Create a button
+ * @brief Measure text from a per-byte advance table instead of the text_width callback
+ * 
+ * Widths become a sum of advances[byte] over the string (an AVX2 gather loop when
+ * available), with no indirect call per string. For UTF-8 text, give lead bytes
+ * (0xC0-0xFF) the advance of their character and continuation bytes (0x80-0xBF) 0.
+ * Fold the font spacing into the advances. With a kerning hook the adjustment for
+ * every adjacent byte pair is added, and the results go through the text cache.
+ * qui_set_font() clears the table, so call this after it.
+ * 
  * @param ctx Context pointer (must not be NULL)
- * @param label Button text (must not be NULL)
- * @return 1 if clicked, 0 otherwise, negative on error
+ * @param advances 256 advances, kept by reference (NULL to go back to text_width)
+ * @param kerning Pair adjustment, or NULL for none
+ * @return QUI_OK on success, error code on failure
  */
-int qui_button(qui_Context *ctx, const char *label);
+qui_Result qui_set_font_advances(qui_Context *ctx, const float *advances,
+                                 float (*kerning)(qui_Context *ctx, unsigned char left, unsigned char right));
 
 /**
- * @brief Create a checkbox
+ * @brief Drop all cached text measurements
+ * 
+ * Measurements are keyed by text, font, font size and spacing, so this is only needed
+ * when the backend's metrics change behind the same font handle. qui_set_font() calls it.
+ * 
  * @param ctx Context pointer (must not be NULL)
- * @param label Checkbox label (must not be NULL)
- * @param value Pointer to boolean value (must not be NULL)
- * @return 1 if value changed, 0 otherwise, negative on error
+ * @return QUI_OK on success, error code on failure
  */
-int qui_checkbox(qui_Context *ctx, const char *label, int *value);
+qui_Result qui_invalidate_text_cache(qui_Context *ctx);
 
-/**
- * @brief Create a floating-point slider
+/* ================================================================================================
+ * WIDGET IDS
+ * ================================================================================================ */
+
+/**
+ * @brief Compute the ID a widget with this label gets in the current ID scope
+ * 
+ * IDs are an FNV-1a hash of the label seeded by the innermost qui_push_id() scope, so
+ * they stay the same from frame to frame no matter which other widgets are shown.
+ * Two widgets with the same label in the same scope share an ID; wrap them in
+ * qui_push_id()/qui_pop_id() to tell them apart.
+ * 
+ * @param ctx Context pointer (must not be NULL)
+ * @param str Label or other identifying string (must not be NULL)
+ * @return Widget ID, 0 on error
+ */
+qui_Id qui_get_id(qui_Context *ctx, const char *str);
+
+/**
+ * @brief qui_get_id() for a string of known length (need not be terminated)
+ * @param ctx Context pointer (must not be NULL)
+ * @param str Identifying bytes (must not be NULL)
+ * @param length Number of bytes
+ * @return Widget ID, 0 on error
+ */
+qui_Id qui_get_id_n(qui_Context *ctx, const char *str, size_t length);
+
+/**
+ * @brief Open an ID scope seeded by a string
+ * @param ctx Context pointer (must not be NULL)
+ * @param str Scope name (must not be NULL)
+ * @return QUI_OK on success, error code on failure
+ */
+qui_Result qui_push_id(qui_Context *ctx, const char *str);
+
+/**
+ * @brief qui_push_id() for a string of known length (need not be terminated)
+ * @param ctx Context pointer (must not be NULL)
+ * @param str Scope name bytes (must not be NULL)
+ * @param length Number of bytes
+ * @return QUI_OK on success, error code on failure
+ */
+qui_Result qui_push_id_n(qui_Context *ctx, const char *str, size_t length);
+
+/**
+ * @brief Open an ID scope seeded by an integer (e.g. a loop index)
+ * @param ctx Context pointer (must not be NULL)
+ * @param value Scope value
+ * @return QUI_OK on success, error code on failure
+ */
+qui_Result qui_push_id_int(qui_Context *ctx, int value);
+
+/**
+ * @brief Close the innermost ID scope
+ * @param ctx Context pointer (must not be NULL)
+ * @return QUI_OK on success, error code on failure
+ */
+qui_Result qui_pop_id(qui_Context *ctx);
+
+/* ================================================================================================
+ * CLIPPING
+ * ================================================================================================ */
+
+/**
+ * @brief Restrict following widgets to a rectangle
+ * 
+ * The rectangle is in layout coordinates (like widget positions) and is intersected
+ * with the enclosing clip region. Widgets entirely outside are neither drawn nor
+ * hit-tested; they only advance the layout. Windows clip their body automatically.
+ * 
+ * @param ctx Context pointer (must not be NULL)
+ * @param rect Clip rectangle
+ * @return QUI_OK on success, error code on failure
+ */
+qui_Result qui_push_clip(qui_Context *ctx, qui_Rect rect);
+
+/**
+ * @brief Restore the clip region active before the matching qui_push_clip()
+ * @param ctx Context pointer (must not be NULL)
+ * @return QUI_OK on success, error code on failure
+ */
+qui_Result qui_pop_clip(qui_Context *ctx);
+
+/* ================================================================================================
+ * WIDGET STATE
+ * ================================================================================================ */
+
+/**
+ * @brief Get the persistent state block of a widget, creating it if needed
+ * 
+ * New blocks are zero-filled. A block stays valid until its widget goes unused for
+ * more frames than the store's maximum age; then it is recycled. Blocks come from a
+ * pool and are reused, so steady-state frames do not allocate.
+ * 
+ * @param ctx Context pointer (must not be NULL)
+ * @param id Widget ID (must not be 0)
+ * @param size Size of the state (must be <= QUI_STATE_BLOCK_SIZE)
+ * @return Pointer to the state block, NULL on error or allocation failure
+ */
+void* qui_get_state(qui_Context *ctx, qui_Id id, size_t size);
+
+/**
+ * @brief Set how many unused frames a widget state survives before it is evicted
+ * @param ctx Context pointer (must not be NULL)
+ * @param frames Maximum age in frames (must be > 0)
+ * @return QUI_OK on success, error code on failure
+ */
+qui_Result qui_set_state_max_age(qui_Context *ctx, uint32_t frames);
+
+/* ================================================================================================
+ * FRAME ARENA
+ * ================================================================================================ */
+
+/**
+ * @brief Allocate scratch memory that lives until the next qui_begin()
+ * @param ctx Context pointer (must not be NULL)
+ * @param size Number of bytes (16-byte aligned)
+ * @return Pointer to the memory, NULL if out of memory
+ */
+void* qui_frame_alloc(qui_Context *ctx, size_t size);
+
+/**
+ * @brief Copy a string into the frame arena
+ * @param ctx Context pointer (must not be NULL)
+ * @param str String to copy (must not be NULL)
+ * @return Copy that lives until the next qui_begin(), NULL if out of memory
+ */
+char* qui_frame_strdup(qui_Context *ctx, const char *str);
+
+/**
+ * @brief Copy at most len bytes of a string into the frame arena and terminate it
+ * @param ctx Context pointer (must not be NULL)
+ * @param str String to copy (must not be NULL)
+ * @param len Number of bytes to copy
+ * @return Copy that lives until the next qui_begin(), NULL if out of memory
+ */
+char* qui_frame_strndup(qui_Context *ctx, const char *str, size_t len);
+
+/**
+ * @brief Format a string into the frame arena
+ * @param ctx Context pointer (must not be NULL)
+ * @param fmt printf-style format string (must not be NULL)
+ * @return Formatted string that lives until the next qui_begin(), NULL on failure
+ */
+const char* qui_frame_printf(qui_Context *ctx, const char *fmt, ...);
+
+/**
+ * @brief Resize the frame arena (between frames only)
+ *
+ * A frame that outgrows the arena chains extra blocks, and the next qui_begin() replaces
+ * them with one block large enough for that frame. Setting the size up front avoids the
+ * allocations of that first large frame.
+ *
+ * @param ctx Context pointer (must not be NULL)
+ * @param size New size in bytes (must be > 0)
+ * @return QUI_OK on success, error code on failure
+ */
+qui_Result qui_set_frame_arena_size(qui_Context *ctx, size_t size);
+
+/* ================================================================================================
+ * STATISTICS
+ * ================================================================================================ */
+
+/**
+ * @brief Counters for the last frame
+ * 
+ * Read after qui_end(). Counters are only collected when QUI_STATS is defined
+ * before including the implementation; without it they are all zero and the
+ * library pays nothing for them.
+ * 
+ * @param ctx Context pointer
+ * @return Frame counters, NULL if ctx is NULL
+ */
+const qui_Stats* qui_get_stats(const qui_Context *ctx);
+
+/**
+ * @brief Monotonic clock in nanoseconds
+ * 
+ * Only QUI_STATS and QUI_TRACE need a clock; without them this returns 0. Uses
+ * clock_gettime(CLOCK_MONOTONIC) where <time.h> declares it (strict C99 builds need
+ * _POSIX_C_SOURCE defined before any include) and C11 timespec_get otherwise, which
+ * includes MSVC. Define QUI_TIME_NS() next to QUI_IMPLEMENTATION to supply your own clock.
+ * 
+ * @return Nanoseconds since an unspecified starting point (0 when nothing is timed)
+ */
+uint64_t qui_time_ns(void);
+
+/* ================================================================================================
+ * TRACING
+ * ================================================================================================ */
+
+/**
+ * @brief Start or stop recording a timeline of scoped regions
+ * 
+ * Requires QUI_TRACE to be defined before including the implementation. Frames,
+ * windows, user scopes and every backend callback (draw_rect, draw_text, draw_image,
+ * set_clip, text_width, text_height) are timed and kept in a ring buffer of the
+ * most recent events. Recording never allocates or locks; call it and flush from
+ * the thread that runs the UI.
+ * 
+ * @param ctx Context pointer (must not be NULL)
+ * @param capacity Events kept (rounded up to a power of two), or 0 to stop and free the buffer
+ * @return QUI_OK on success, QUI_ERROR_INVALID_STATE if tracing is compiled out
+ */
+qui_Result qui_enable_trace(qui_Context *ctx, int capacity);
+
+/**
+ * @brief Begin a named user scope in the trace
+ * @param ctx Context pointer (must not be NULL)
+ * @param name Scope name (must not be NULL, must stay valid until qui_trace_end())
+ * @return QUI_OK on success, error code on failure
+ */
+qui_Result qui_trace_begin(qui_Context *ctx, const char *name);
+
+/**
+ * @brief End the innermost scope begun with qui_trace_begin()
+ * @param ctx Context pointer (must not be NULL)
+ * @return QUI_OK on success, error code on failure
+ */
+qui_Result qui_trace_end(qui_Context *ctx);
+
+/**
+ * @brief Write the buffered events as Chrome trace-event JSON and empty the buffer
+ * 
+ * The output loads in chrome://tracing and ui.perfetto.dev.
+ * 
+ * @param ctx Context pointer (must not be NULL)
+ * @param file Output file (must not be NULL)
+ * @return QUI_OK on success, error code on failure
+ */
+qui_Result qui_trace_write_json(qui_Context *ctx, FILE *file);
+
+/* ================================================================================================
+ * DRAW LIST
+ * ================================================================================================ */
+
+/**
+ * @brief Record draw commands into a draw list instead of calling the rendering callbacks
+ * 
+ * Storage is allocated once here; recording itself never allocates. Drawn strings are
+ * copied into the frame arena. The list is cleared by qui_begin() and is complete after
+ * qui_end(). Commands that do not fit are dropped and counted in qui_DrawList::dropped.
+ * 
+ * @param ctx Context pointer (must not be NULL)
+ * @param max_commands Maximum number of commands per frame (must be > 0)
+ * @return QUI_OK on success, error code on failure
+ */
+qui_Result qui_enable_draw_list(qui_Context *ctx, int max_commands);
+
+/**
+ * @brief Release the draw list and go back to calling the rendering callbacks directly
+ * @param ctx Context pointer (must not be NULL)
+ * @return QUI_OK on success, error code on failure
+ */
+qui_Result qui_disable_draw_list(qui_Context *ctx);
+
+/**
+ * @brief Get the draw list recorded during the last frame
+ * @param ctx Context pointer
+ * @return Draw list, or NULL if recording is not enabled
+ */
+const qui_DrawList* qui_get_draw_list(const qui_Context *ctx);
+
+/**
+ * @brief Replay a draw list through the context's rendering callbacks
+ * @param ctx Context pointer (must not be NULL)
+ * @param list Draw list to replay (must not be NULL)
+ * @return QUI_OK on success, error code on failure
+ */
+qui_Result qui_render_draw_list(qui_Context *ctx, const qui_DrawList *list);
+
+/* ================================================================================================
+ * VERTEX OUTPUT
+ * ================================================================================================ */
+
+/**
+ * @brief Allocate vertex, index and batch storage
+ * @param vb Vertex buffer (must not be NULL)
+ * @param max_quads Maximum number of quads per frame (must be > 0)
+ * @param index_size Index size in bytes, 2 for uint16_t or 4 for uint32_t
+ * @return QUI_OK on success, error code on failure
+ */
+qui_Result qui_vertex_buffer_init(qui_VertexBuffer *vb, int max_quads, int index_size);
+
+/**
+ * @brief Release vertex buffer storage
+ * @param vb Vertex buffer (must not be NULL)
+ * @return QUI_OK on success, error code on failure
+ */
+qui_Result qui_vertex_buffer_free(qui_VertexBuffer *vb);
+
+/**
+ * @brief Convert a draw list into triangles grouped into batches by texture
+ * 
+ * Rects and images become textured quads (two triangles each). Consecutive quads
+ * that share a texture are merged into one batch. With an atlas font (qui_use_font())
+ * text becomes glyph quads and rects use the atlas too. Otherwise commands that
+ * cannot be tessellated (text) get a batch of their own with qui_DrawBatch::command
+ * set, so painter's order is preserved.
+ * 
+ * @param list Draw list to convert (must not be NULL)
+ * @param vb Output vertex buffer (must be initialized)
+ * @return QUI_OK on success, error code on failure
+ */
+qui_Result qui_build_vertex_buffer(const qui_DrawList *list, qui_VertexBuffer *vb);
+
+/* ================================================================================================
+ * FONTS
+ * ================================================================================================ */
+
+/**
+ * @brief Create an empty font atlas
+ * 
+ * Add glyphs with qui_font_add_glyph(), or use qui_font_init_default() for the
+ * built-in font.
+ * 
+ * @param font Font to initialize (must not be NULL)
+ * @param atlas_width Atlas width in pixels (1-65535)
+ * @param atlas_height Atlas height in pixels (1-65535)
+ * @param line_height Text height
+ * @return QUI_OK on success, error code on failure
+ */
+qui_Result qui_font_init(qui_Font *font, int atlas_width, int atlas_height, float line_height);
+
+/**
+ * @brief Create a font from the built-in 5x7 bitmap font (ASCII 32-126)
+ * @param font Font to initialize (must not be NULL)
+ * @param scale Integer pixel scale (must be > 0)
+ * @return QUI_OK on success, error code on failure
+ */
+qui_Result qui_font_init_default(qui_Font *font, int scale);
+
+/**
+ * @brief Pack one glyph bitmap into the atlas
+ * 
+ * The bitmap is one coverage byte per pixel. Point it into a bitmap sheet with the
+ * sheet's stride, or at glyphs rasterized from a TTF (for example with stb_truetype).
+ * Glyphs are placed with a skyline bottom-left packer and a 1 pixel gap.
+ * 
+ * @param font Font (must not be NULL)
+ * @param codepoint Code point below QUI_FONT_GLYPH_COUNT
+ * @param coverage Bitmap (may be NULL if width or height is 0)
+ * @param width Bitmap width
+ * @param height Bitmap height
+ * @param stride Bytes between bitmap rows (0 for width)
+ * @param offset_x Bitmap offset from the pen position
+ * @param offset_y Bitmap offset from the top of the line
+ * @param advance Pen advance
+ * @return QUI_OK on success, QUI_ERROR_BUFFER_TOO_SMALL if the atlas is full
+ */
+qui_Result qui_font_add_glyph(qui_Font *font, uint32_t codepoint, const unsigned char *coverage,
+                              int width, int height, int stride,
+                              float offset_x, float offset_y, float advance);
+
+/**
+ * @brief Release the atlas memory of a font
+ * @param font Font (must not be NULL)
+ * @return QUI_OK on success, error code on failure
+ */
+qui_Result qui_font_free(qui_Font *font);
+
+/**
+ * @brief Measure and draw text with an atlas font instead of the text callbacks
+ * 
+ * Text width and height become table lookups. Draw lists carry the font, so
+ * qui_build_vertex_buffer() turns text into glyph quads and gives rects the atlas's
+ * opaque texel: rects and text then share one texture and one batch. Backends sample
+ * the atlas as coverage and multiply by the vertex color. The draw_text callback
+ * still receives text on the direct path; the software renderer draws it from the atlas.
+ * 
+ * @param ctx Context pointer (must not be NULL)
+ * @param font Font to use (must outlive its use), or NULL for the text callbacks
+ * @return QUI_OK on success, error code on failure
+ */
+qui_Result qui_use_font(qui_Context *ctx, qui_Font *font);
+
+/* ================================================================================================
+ * IMAGE ATLAS
+ * ================================================================================================ */
+
+/**
+ * @brief Create an empty image atlas
+ * 
+ * Pages are allocated as images are added.
+ * 
+ * @param atlas Atlas to initialize (must not be NULL, must not move while its images are used)
+ * @param page_width Page width in pixels (must be > 2)
+ * @param page_height Page height in pixels (must be > 2)
+ * @return QUI_OK on success, error code on failure
+ */
+qui_Result qui_image_atlas_init(qui_ImageAtlas *atlas, int page_width, int page_height);
+
+/**
+ * @brief Copy an image into the atlas
+ * 
+ * The pixels are converted to RGBA (1 channel: gray, 2: gray and alpha, 3: RGB) and
+ * placed on the first page with room, with a 1 pixel gap. The source pixels can be
+ * freed afterwards. Pass the result to the image widgets: images on the same page
+ * share one texture, so qui_build_vertex_buffer() puts them in one batch. Adding the
+ * tallest images first packs tightest.
+ * 
+ * @param atlas Atlas (must not be NULL)
+ * @param source Image with tightly packed 8-bit pixels, not already packed (must not be NULL)
+ * @param out Receives the packed image (may be source)
+ * @return QUI_OK on success, QUI_ERROR_BUFFER_TOO_SMALL if all pages are full,
+ *         QUI_ERROR_INVALID_VALUE if the image is larger than a page
+ */
+qui_Result qui_image_atlas_add(qui_ImageAtlas *atlas, const qui_Image *source, qui_Image *out);
+
+/**
+ * @brief Release the pages of an image atlas
+ * @param atlas Atlas (must not be NULL)
+ * @return QUI_OK on success, error code on failure
+ */
+qui_Result qui_image_atlas_free(qui_ImageAtlas *atlas);
+
+/**
+ * @brief Texture coordinates of an image in the texture it is drawn from
+ * 
+ * Packed images map to their sub-rect of image->page; standalone images to 0..1.
+ * 
+ * @param image Image (must not be NULL)
+ * @param uv Receives u0, v0, u1, v1
+ * @return QUI_OK on success, error code on failure
+ */
+qui_Result qui_image_uv(const qui_Image *image, float uv[4]);
+
+/* ================================================================================================
+ * UI ELEMENTS
+ * ================================================================================================ */
+
+/**
+ * @brief Create a button
+ * @param ctx Context pointer (must not be NULL)
+ * @param label Button text (must not be NULL)
+ * @return 1 if clicked, 0 otherwise, negative on error
+ */
+int qui_button(qui_Context *ctx, const char *label);
+
+/**
+ * @brief Create a checkbox
+ * @param ctx Context pointer (must not be NULL)
+ * @param label Checkbox label (must not be NULL)
+ * @param value Pointer to boolean value (must not be NULL)
+ * @return 1 if value changed, 0 otherwise, negative on error
+ */
+int qui_checkbox(qui_Context *ctx, const char *label, int *value);
+
+/**
+ * @brief Create a floating-point slider
  * @param ctx Context pointer (must not be NULL)
  * @param label Slider label (must not be NULL)
  * @param value Pointer to float value (must not be NULL)
@@ -447,6 +1747,13 @@ int qui_slider(qui_Context *ctx, const char *label, float *value, float min_val,
 
 /**
  * @brief Create a text input box
+ * 
+ * Edits a NUL-terminated UTF-8 buffer in place. Clicking focuses the box and places
+ * the caret; dragging selects. Typed text (qui_feed_text()) and keys (qui_feed_key())
+ * edit at the caret. The caret, selection, scroll offset and text length are kept
+ * in the widget state store, so a frame without edits does not scan the buffer
+ * and only the visible characters are measured and drawn.
+ * 
  * @param ctx Context pointer (must not be NULL)
  * @param buffer Text buffer (must not be NULL)
  * @param capacity Buffer capacity (must be > 0)
@@ -510,42 +1817,362 @@ bool qui_begin_window(qui_Context *ctx, const char *title, qui_Vec2 size, qui_Ve
  */
 qui_Result qui_end_window(qui_Context *ctx);
 
-#ifdef __cplusplus
-}
-#endif
-
-#endif /* QUICK_UI_H */
-
 /* ================================================================================================
- * IMPLEMENTATION
+ * LAYOUT
  * ================================================================================================ */
 
-#ifdef QUI_IMPLEMENTATION
+/** @brief Column sized to its widest widget */
+qui_Size qui_size_auto(void);
 
-#include <string.h>
-#include <stdio.h>
-#include <stdlib.h>
-#include <math.h>
+/** @brief Column with a fixed width in pixels */
+qui_Size qui_size_fixed(float pixels);
 
-/* ================================================================================================
+/** @brief Column taking a percentage (0-100) of the row width left after column spacing */
+qui_Size qui_size_percent(float percent);
+
+/** @brief Column sharing the remaining width with other flex columns by weight */
+qui_Size qui_size_flex(float weight);
+
+/**
+ * @brief Lay the following widgets out in rows of cells
+ * 
+ * Widgets fill the cells left to right and wrap to a new row after the last column,
+ * so a row layout with more widgets than columns is a grid. Fixed and percent
+ * columns are resolved first, auto columns take the widest widget measured in that
+ * column last frame (cached per row in the widget state store), and flex columns
+ * share what is left. Call qui_layout_end() to return to a single column.
+ * 
+ * @code
+ * qui_Size cols[3] = { qui_size_auto(), qui_size_flex(1), qui_size_fixed(80) };
+ * qui_layout_row(&ui, 3, cols, 0);
+ * qui_button(&ui, "Name");  qui_textbox(&ui, name, sizeof(name), 0);  qui_button(&ui, "Clear");
+ * qui_layout_end(&ui);
+ * @endcode
+ * 
+ * @param ctx Context pointer (must not be NULL)
+ * @param columns Number of columns (1 to QUI_LAYOUT_MAX_COLUMNS)
+ * @param sizes Column sizes, or NULL for equal flex columns
+ * @param width Row width, or 0 for the width of the enclosing window or scroll region
+ * @return QUI_OK on success, error code on failure
+ */
+qui_Result qui_layout_row(qui_Context *ctx, int columns, const qui_Size *sizes, float width);
+
+/**
+ * @brief Set how widgets are aligned inside the cells of the current row layout
+ * @param ctx Context pointer (must not be NULL)
+ * @param horizontal Alignment within the column width
+ * @param vertical Alignment within the row height
+ * @return QUI_OK on success, error code on failure
+ */
+qui_Result qui_layout_align(qui_Context *ctx, qui_Align horizontal, qui_Align vertical);
+
+/**
+ * @brief End the current row layout and continue below it in a single column
+ * @param ctx Context pointer (must not be NULL)
+ * @return QUI_OK on success, error code on failure
+ */
+qui_Result qui_layout_end(qui_Context *ctx);
+
+/* ================================================================================================
+ * SCROLL REGIONS
+ * ================================================================================================ */
+
+/**
+ * @brief Begin a fixed-size region whose contents scroll vertically
+ * 
+ * Contents are laid out from the region's top-left corner and clipped to it. The mouse
+ * wheel scrolls the innermost region under the mouse; a scrollbar appears when the
+ * contents were taller than the region last frame. The scroll position is kept in
+ * the widget state store. Call qui_end_scroll_region() only if this returns true.
+ * 
+ * @param ctx Context pointer (must not be NULL)
+ * @param name Region name used for its ID (must not be NULL)
+ * @param width Region width (must be > 0)
+ * @param height Region height (must be > 0)
+ * @return true if the region was opened
+ */
+bool qui_begin_scroll_region(qui_Context *ctx, const char *name, float width, float height);
+
+/**
+ * @brief End the innermost scroll region and advance the outer layout past it
+ * @param ctx Context pointer (must not be NULL)
+ * @return QUI_OK on success, error code on failure
+ */
+qui_Result qui_end_scroll_region(qui_Context *ctx);
+
+/**
+ * @brief Start a list of fixed-height rows and compute which rows are visible
+ * 
+ * Moves the layout cursor to the first visible row. Draw rows display_start to
+ * display_end - 1, each advancing the layout by item_height (widget height plus
+ * spacing), then call qui_list_clipper_end(). Without a clip region all rows are
+ * visible.
+ * 
+ * @code
+ * qui_ListClipper clip;
+ * qui_list_clipper_begin(&ui, &clip, 1000000, 30.0f);
+ * for (int i = clip.display_start; i < clip.display_end; i++) {
+ *     qui_push_id_int(&ui, i);
+ *     qui_button(&ui, rows[i]);
+ *     qui_pop_id(&ui);
+ * }
+ * qui_list_clipper_end(&ui, &clip);
+ * @endcode
+ * 
+ * @param ctx Context pointer (must not be NULL)
+ * @param clipper Clipper to fill (must not be NULL)
+ * @param item_count Number of rows (must be >= 0)
+ * @param item_height Advance of one row (must be > 0)
+ * @return QUI_OK on success, error code on failure
+ */
+qui_Result qui_list_clipper_begin(qui_Context *ctx, qui_ListClipper *clipper, int item_count, float item_height);
+
+/**
+ * @brief Start a list of variable-height rows and compute which rows are visible
+ * 
+ * Row i spans offsets[i] to offsets[i + 1] below the list start, so the visible range
+ * is found by binary search. Keep the offsets between frames and rebuild them only
+ * when row heights change.
+ * 
+ * @param ctx Context pointer (must not be NULL)
+ * @param clipper Clipper to fill (must not be NULL)
+ * @param item_count Number of rows (must be >= 0)
+ * @param offsets item_count + 1 non-decreasing offsets, offsets[0] == 0 (must not be NULL)
+ * @return QUI_OK on success, error code on failure
+ */
+qui_Result qui_list_clipper_begin_offsets(qui_Context *ctx, qui_ListClipper *clipper, int item_count, const float *offsets);
+
+/**
+ * @brief Finish a clipped list and move the layout cursor below its last row
+ * @param ctx Context pointer (must not be NULL)
+ * @param clipper Clipper from qui_list_clipper_begin() (must not be NULL)
+ * @return QUI_OK on success, error code on failure
+ */
+qui_Result qui_list_clipper_end(qui_Context *ctx, qui_ListClipper *clipper);
+
+/* ================================================================================================
+ * TEXT DOCUMENTS
+ * ================================================================================================ */
+
+/**
+ * @brief Open a document on existing text
+ * 
+ * The text is not copied and must stay valid and unchanged until qui_textdoc_free().
+ * Opening scans it once to index its lines; after that, memory grows with the edits
+ * (the inserted bytes plus a few words per piece), not with the document.
+ * 
+ * @param doc Document to initialize (must not be NULL)
+ * @param text Initial text, not necessarily NUL-terminated (may be NULL if length is 0)
+ * @param length Bytes of text
+ * @return QUI_OK on success, error code on failure
+ */
+qui_Result qui_textdoc_init(qui_TextDoc *doc, const char *text, size_t length);
+
+/**
+ * @brief Release the memory owned by a document
+ * @param doc Document (must not be NULL)
+ * @return QUI_OK on success, error code on failure
+ */
+qui_Result qui_textdoc_free(qui_TextDoc *doc);
+
+/**
+ * @brief Insert bytes at a document offset
+ * 
+ * Costs O(pieces). Typing at the end of the previous insertion extends that piece
+ * instead of adding one.
+ * 
+ * @param doc Document (must not be NULL)
+ * @param pos Byte offset, at most doc->length
+ * @param text Bytes to insert (must not be NULL)
+ * @param length Bytes of text
+ * @return QUI_OK on success, error code on failure
+ */
+qui_Result qui_textdoc_insert(qui_TextDoc *doc, size_t pos, const char *text, size_t length);
+
+/**
+ * @brief Remove bytes from a document
+ * @param doc Document (must not be NULL)
+ * @param pos Byte offset of the first byte to remove
+ * @param length Bytes to remove (clamped to the end of the document)
+ * @return QUI_OK on success, error code on failure
+ */
+qui_Result qui_textdoc_erase(qui_TextDoc *doc, size_t pos, size_t length);
+
+/**
+ * @brief Copy a range of a document into a buffer
+ * @param doc Document (must not be NULL)
+ * @param pos Byte offset to start at
+ * @param out Destination (must not be NULL if length > 0); not NUL-terminated
+ * @param length Bytes to copy at most
+ * @return Bytes copied
+ */
+size_t qui_textdoc_copy(const qui_TextDoc *doc, size_t pos, char *out, size_t length);
+
+/**
+ * @brief Byte offset where a line starts
+ * @param doc Document (must not be NULL)
+ * @param line Zero-based line; lines past the end return doc->length
+ * @return Byte offset
+ */
+size_t qui_textdoc_line_start(const qui_TextDoc *doc, size_t line);
+
+/**
+ * @brief Line that contains a byte offset
+ * @param doc Document (must not be NULL)
+ * @param pos Byte offset (clamped to doc->length)
+ * @return Zero-based line
+ */
+size_t qui_textdoc_line_of(const qui_TextDoc *doc, size_t pos);
+
+/**
+ * @brief Multi-line editor for a qui_TextDoc
+ * 
+ * A scroll region of the given size that lays out one line per row and draws only
+ * the visible lines, each cut to QUI_EDITOR_LINE_BYTES. Clicking focuses it and places
+ * the caret, dragging selects; typed text, QUI_KEY_ENTER and the navigation keys edit
+ * the document. The caret and selection are kept in the widget state store. Each
+ * keystroke costs O(pieces + log lines), independent of the document size.
+ * 
+ * @param ctx Context pointer (must not be NULL)
+ * @param name Editor name used for its ID (must not be NULL)
+ * @param doc Document to show and edit (must not be NULL)
+ * @param width Editor width (must be > 0)
+ * @param height Editor height (must be > 0)
+ * @return 1 if focused, 0 otherwise, negative on error
+ */
+int qui_text_editor(qui_Context *ctx, const char *name, qui_TextDoc *doc, float width, float height);
+
+#ifdef QUI_SOFTWARE_RENDERER
+
+/* ================================================================================================
+ * SOFTWARE RENDERER
+ * ================================================================================================ */
+
+/** @brief RGBA8 framebuffer target for the built-in software renderer */
+typedef struct {
+    uint32_t *pixels; /**< Pixel memory, RGBA8 byte order (see qui_pack_color) */
+    int width;        /**< Width in pixels */
+    int height;       /**< Height in pixels */
+    int stride;       /**< Distance between rows in pixels */
+    int clip_x0;      /**< Left edge of the drawable area */
+    int clip_y0;      /**< Top edge of the drawable area */
+    int clip_x1;      /**< Right edge (exclusive) of the drawable area */
+    int clip_y1;      /**< Bottom edge (exclusive) of the drawable area */
+    qui_Rect scissor; /**< Scissor set by the context through set_clip */
+    bool scissor_set; /**< Scissor active */
+} qui_Framebuffer;
+
+/**
+ * @brief Wrap caller-owned pixel memory in a framebuffer
+ * @param fb Framebuffer (must not be NULL)
+ * @param pixels Pixel memory of at least stride * height pixels (must not be NULL)
+ * @param width Width in pixels (must be > 0)
+ * @param height Height in pixels (must be > 0)
+ * @param stride Pixels per row (0 for width)
+ * @return QUI_OK on success, error code on failure
+ */
+qui_Result qui_framebuffer_init(qui_Framebuffer *fb, uint32_t *pixels, int width, int height, int stride);
+
+/**
+ * @brief Restrict all software rendering to a rectangle
+ * 
+ * Used with damage tracking: clear and replay the draw list once per damage
+ * rectangle to repaint only what changed.
+ * 
+ * @param fb Framebuffer (must not be NULL)
+ * @param clip Drawable area, or NULL for the whole framebuffer
+ * @return QUI_OK on success, error code on failure
+ */
+qui_Result qui_framebuffer_set_clip(qui_Framebuffer *fb, const qui_Rect *clip);
+
+/**
+ * @brief Fill the framebuffer clip area with a color
+ * @param fb Framebuffer (must not be NULL)
+ * @param color Clear color
+ * @return QUI_OK on success, error code on failure
+ */
+qui_Result qui_framebuffer_clear(qui_Framebuffer *fb, qui_Color color);
+
+/**
+ * @brief Install the software renderer callbacks on a context
+ * 
+ * Sets draw_rect, draw_text, draw_image, set_clip, text_width and text_height. Text uses the
+ * built-in 5x7 bitmap font scaled to the context font size, or the atlas font set with
+ * qui_use_font(). Images are read as
+ * tightly packed 8-bit pixels with qui_Image::channels components.
+ * 
+ * @param ctx Context pointer (must not be NULL)
+ * @param fb Target framebuffer (must not be NULL)
+ * @return QUI_OK on success, error code on failure
+ */
+qui_Result qui_use_software_renderer(qui_Context *ctx, qui_Framebuffer *fb);
+
+#endif /* QUI_SOFTWARE_RENDERER */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* QUICK_UI_H */
+
+/* ================================================================================================
+ * IMPLEMENTATION
+ * ================================================================================================ */
+
+#ifdef QUI_IMPLEMENTATION
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <math.h>
+#include <limits.h>
+#include <time.h>
+
+/** @brief SIMD instruction set selection (define QUI_NO_SIMD to force scalar code) */
+#if !defined(QUI_NO_SIMD) && defined(__AVX2__)
+#define QUI_SIMD_AVX2
+#define QUI_SIMD_SSE2
+#include <immintrin.h>
+#elif !defined(QUI_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define QUI_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+/* ================================================================================================
  * INTERNAL CONSTANTS AND HELPERS
  * ================================================================================================ */
 
+/** @brief Pack constant components into a qui_Color32 */
+#define QUI_RGBA(r, g, b, a) ((qui_Color32)(r) | ((qui_Color32)(g) << 8) | ((qui_Color32)(b) << 16) | ((qui_Color32)(a) << 24))
+
 /** @brief Default color palette */
-static const qui_Color QUI_DEFAULT_COLORS[QUI_COLOR_COUNT] = {
-    {32,  32,  32,  255}, /* QUI_COLOR_BACKGROUND */
-    {56,  56,  56,  255}, /* QUI_COLOR_FOREGROUND */
-    {80,  80,  80,  255}, /* QUI_COLOR_HOT */
-    {100, 100, 100, 255}, /* QUI_COLOR_ACTIVE */
-    {255, 255, 255, 255}, /* QUI_COLOR_TEXT */
-    {48,  48,  48,  255}, /* QUI_COLOR_WINDOW_BG */
-    {64,  64,  64,  255}  /* QUI_COLOR_TITLE_BAR */
+static const qui_Color32 QUI_DEFAULT_COLORS[QUI_COLOR_COUNT] = {
+    QUI_RGBA(32,  32,  32,  255), /* QUI_COLOR_BACKGROUND */
+    QUI_RGBA(56,  56,  56,  255), /* QUI_COLOR_FOREGROUND */
+    QUI_RGBA(80,  80,  80,  255), /* QUI_COLOR_HOT */
+    QUI_RGBA(100, 100, 100, 255), /* QUI_COLOR_ACTIVE */
+    QUI_RGBA(255, 255, 255, 255), /* QUI_COLOR_TEXT */
+    QUI_RGBA(48,  48,  48,  255), /* QUI_COLOR_WINDOW_BG */
+    QUI_RGBA(64,  64,  64,  255), /* QUI_COLOR_TITLE_BAR */
+    QUI_RGBA(60,  100, 160, 255)  /* QUI_COLOR_SELECTION */
 };
 
 /** @brief Default spacing values */
 #define QUI_DEFAULT_SPACING_X 8.0f
 #define QUI_DEFAULT_SPACING_Y 8.0f
 
+/** @brief Allocator hooks (override before including the implementation) */
+#ifndef QUI_MALLOC
+#define QUI_MALLOC(size) malloc(size)
+#endif
+#ifndef QUI_REALLOC
+#define QUI_REALLOC(ptr, size) realloc(ptr, size)
+#endif
+#ifndef QUI_FREE
+#define QUI_FREE(ptr) free(ptr)
+#endif
+
 /** @brief Default text metrics when callbacks aren't available */
 #define QUI_FALLBACK_CHAR_WIDTH 8.0f
 #define QUI_FALLBACK_TEXT_HEIGHT 16.0f
@@ -561,23 +2188,316 @@ static const qui_Color QUI_DEFAULT_COLORS[QUI_COLOR_COUNT] = {
         if (!(ptr)) return QUI_ERROR_NULL_POINTER; \
     } while(0)
 
-/** @brief Generate unique ID for UI element */
-static qui_Id qui_gen_id(qui_Context *ctx) {
+/** @brief Check widget IDs for duplicates (on unless NDEBUG is defined) */
+#if !defined(QUI_CHECK_IDS) && !defined(NDEBUG)
+#define QUI_CHECK_IDS
+#endif
+
+/** @brief Frame counters (compiled out unless QUI_STATS is defined) */
+#ifdef QUI_STATS
+#define QUI_STAT_ADD(ctx, field, n) ((ctx)->stats.field += (n))
+#else
+#define QUI_STAT_ADD(ctx, field, n) ((void)0)
+#endif
+
+/** @brief Scoped timeline events (compiled out unless QUI_TRACE is defined) */
+#ifdef QUI_TRACE
+#define QUI_TRACE_PUSH(ctx, category, name) qui_trace_push(ctx, category, name)
+#define QUI_TRACE_POP(ctx) qui_trace_pop(ctx)
+#else
+#define QUI_TRACE_PUSH(ctx, category, name) ((void)0)
+#define QUI_TRACE_POP(ctx) ((void)0)
+#endif
+
+#ifdef QUI_TRACE
+/** @brief Open a scope on the trace stack */
+static void qui_trace_push(qui_Context *ctx, qui_TraceCategory category, const char *name) {
+    qui_Trace *t = &ctx->trace;
+    if (!t->events) return;
+    
+    if (t->depth < QUI_TRACE_STACK_SIZE) {
+        qui_TraceScope *scope = &t->stack[t->depth];
+        scope->name = name;
+        scope->category = (uint32_t)category;
+        scope->start_ns = qui_time_ns();
+    }
+    t->depth++;
+}
+
+/** @brief Close the innermost scope and write it to the ring buffer */
+static void qui_trace_pop(qui_Context *ctx) {
+    qui_Trace *t = &ctx->trace;
+    if (!t->events || t->depth <= 0) return;
+    
+    if (--t->depth >= QUI_TRACE_STACK_SIZE) return;
+    const qui_TraceScope *scope = &t->stack[t->depth];
+    qui_TraceEvent *e = &t->events[t->written & (t->capacity - 1)];
+    e->duration_ns = qui_time_ns() - scope->start_ns;
+    e->start_ns = scope->start_ns;
+    e->category = scope->category;
+    strncpy(e->name, scope->name ? scope->name : "", QUI_TRACE_NAME_SIZE - 1);
+    e->name[QUI_TRACE_NAME_SIZE - 1] = '\0';
+    t->written++;
+}
+#endif
+
+/** @brief FNV-1a offset basis used as the root ID seed */
+#define QUI_ID_SEED 0x811C9DC5u
+
+/** @brief 32-bit FNV-1a over raw bytes */
+static qui_Id qui_fnv1a32(qui_Id hash, const void *data, size_t size) {
+    const unsigned char *p = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= p[i];
+        hash *= 0x01000193u;
+    }
+    return hash;
+}
+
+/** @brief Seed of the innermost ID scope */
+static qui_Id qui_id_seed(qui_Context *ctx) {
+    return (ctx->id_stack_depth > 0) ? ctx->id_stack[ctx->id_stack_depth - 1] : QUI_ID_SEED;
+}
+
+/** @brief Hash data into an ID in the current scope (never returns 0) */
+static qui_Id qui_hash_id(qui_Context *ctx, const void *data, size_t size) {
+    qui_Id id = qui_fnv1a32(qui_id_seed(ctx), data, size);
+    return (id != 0) ? id : 1;
+}
+
+#ifdef QUI_CHECK_IDS
+/** @brief Double the ID check table, keeping the IDs of this frame */
+static bool qui_grow_id_check(qui_Context *ctx) {
+    uint32_t capacity = ctx->id_seen_capacity ? ctx->id_seen_capacity * 2 : QUI_ID_CHECK_SIZE;
+    qui_IdSlot *slots = (qui_IdSlot*)QUI_MALLOC(sizeof(qui_IdSlot) * capacity);
+    if (!slots) return false;
+    
+    uint32_t frame = ctx->frame_index;
+    uint32_t mask = capacity - 1;
+    for (uint32_t i = 0; i < capacity; i++) slots[i].frame = frame - 1;
+    for (uint32_t i = 0; i < ctx->id_seen_capacity; i++) {
+        if (ctx->id_seen[i].frame != frame) continue;
+        uint32_t slot = ctx->id_seen[i].id & mask;
+        while (slots[slot].frame == frame) slot = (slot + 1) & mask;
+        slots[slot] = ctx->id_seen[i];
+    }
+    QUI_FREE(ctx->id_seen);
+    ctx->id_seen = slots;
+    ctx->id_seen_capacity = capacity;
+    return true;
+}
+
+/** @brief Record an ID for this frame and report duplicates */
+static void qui_check_id(qui_Context *ctx, qui_Id id) {
+    /* Keep the table at most 3/4 full so probes stay short; the size carries over to later frames */
+    if (ctx->id_seen_count * 4 >= ctx->id_seen_capacity * 3 && !qui_grow_id_check(ctx)) return;
+    
+    uint32_t mask = ctx->id_seen_capacity - 1;
+    uint32_t frame = ctx->frame_index;
+    for (uint32_t slot = id & mask;; slot = (slot + 1) & mask) {
+        qui_IdSlot *s = &ctx->id_seen[slot];
+        if (s->frame != frame) {
+            s->id = id;
+            s->frame = frame;
+            ctx->id_seen_count++;
+            return;
+        }
+        if (s->id == id) {
+            ctx->id_collisions++;
+            fprintf(stderr, "quickui: duplicate widget ID 0x%08X, use qui_push_id() to tell widgets apart\n", (unsigned)id);
+            return;
+        }
+    }
+}
+#endif
+
+/** @brief Start collecting the primitives of a widget for damage tracking */
+static void qui_damage_begin_widget(qui_Context *ctx, qui_Id id) {
+    qui_DamageTracker *d = &ctx->damage;
+    
+    if (d->count == d->capacity) {
+        int capacity = d->capacity ? d->capacity * 2 : 256;
+        qui_WidgetRecord *records = (qui_WidgetRecord*)QUI_REALLOC(d->records, sizeof(qui_WidgetRecord) * (size_t)capacity);
+        /* Out of memory: the primitives are merged into the previous record, which is conservative */
+        if (!records) return;
+        d->records = records;
+        d->capacity = capacity;
+    }
+    
+    qui_WidgetRecord *rec = &d->records[d->count++];
+    rec->id = id;
+    rec->hash = 0xCBF29CE484222325ull;
+    rec->x0 = rec->y0 = 1e30f;
+    rec->x1 = rec->y1 = -1e30f;
+}
+
+/** @brief Generate the ID of a widget from identifying data */
+static qui_Id qui_gen_id(qui_Context *ctx, const void *data, size_t size) {
     if (!ctx) return 0;
-    ctx->last_id += 1;
-    if (ctx->last_id == 0) ctx->last_id = 1; /* Avoid zero ID */
-    return ctx->last_id;
+    qui_Id id = qui_hash_id(ctx, data, size);
+    QUI_STAT_ADD(ctx, widgets, 1);
+#ifdef QUI_CHECK_IDS
+    qui_check_id(ctx, id);
+#endif
+    if (ctx->damage.enabled) {
+        qui_damage_begin_widget(ctx, id);
+    }
+    ctx->last_id = id;
+    return id;
+}
+
+/** @brief Generate the ID of a widget from its label */
+static qui_Id qui_gen_id_str(qui_Context *ctx, const char *str) {
+    return qui_gen_id(ctx, str, strlen(str));
+}
+
+/** @brief Generate the ID of a widget identified by a pointer */
+static qui_Id qui_gen_id_ptr(qui_Context *ctx, const void *ptr) {
+    return qui_gen_id(ctx, &ptr, sizeof(ptr));
+}
+
+/** @brief Widget state pool chunk size in blocks */
+#define QUI_STATE_CHUNK_BLOCKS 256
+#define QUI_STATE_NO_BLOCK 0xFFFFFFFFu
+
+/** @brief Home slot of an ID in the state table */
+static uint32_t qui_state_home(const qui_StateStore *store, qui_Id id) {
+    return (uint32_t)(id * 0x9E3779B1u) & (store->slot_capacity - 1);
+}
+
+/** @brief Address of a pooled state block */
+static void* qui_state_block(const qui_StateStore *store, uint32_t block) {
+    return store->chunks[block / QUI_STATE_CHUNK_BLOCKS] +
+           (size_t)(block % QUI_STATE_CHUNK_BLOCKS) * QUI_STATE_BLOCK_SIZE;
+}
+
+/** @brief Take a block from the free list or carve a new one from the pool */
+static uint32_t qui_state_alloc_block(qui_StateStore *store) {
+    if (store->free_block != QUI_STATE_NO_BLOCK) {
+        uint32_t block = store->free_block;
+        memcpy(&store->free_block, qui_state_block(store, block), sizeof(uint32_t));
+        return block;
+    }
+    
+    if (store->block_count == store->chunk_count * QUI_STATE_CHUNK_BLOCKS) {
+        unsigned char **chunks = (unsigned char**)QUI_MALLOC(sizeof(unsigned char*) * (store->chunk_count + 1));
+        unsigned char *chunk = (unsigned char*)QUI_MALLOC((size_t)QUI_STATE_CHUNK_BLOCKS * QUI_STATE_BLOCK_SIZE);
+        if (!chunks || !chunk) {
+            QUI_FREE(chunks);
+            QUI_FREE(chunk);
+            return QUI_STATE_NO_BLOCK;
+        }
+        if (store->chunk_count > 0) {
+            memcpy(chunks, store->chunks, sizeof(unsigned char*) * store->chunk_count);
+        }
+        QUI_FREE(store->chunks);
+        chunks[store->chunk_count++] = chunk;
+        store->chunks = chunks;
+    }
+    
+    return store->block_count++;
+}
+
+/** @brief Return a block to the free list */
+static void qui_state_free_block(qui_StateStore *store, uint32_t block) {
+    memcpy(qui_state_block(store, block), &store->free_block, sizeof(uint32_t));
+    store->free_block = block;
+}
+
+/** @brief Resize the slot table and reinsert all live slots */
+static bool qui_state_rehash(qui_StateStore *store, uint32_t capacity) {
+    qui_StateSlot *slots = (qui_StateSlot*)QUI_MALLOC(sizeof(qui_StateSlot) * capacity);
+    if (!slots) return false;
+    memset(slots, 0, sizeof(qui_StateSlot) * capacity);
+    
+    qui_StateSlot *old_slots = store->slots;
+    uint32_t old_capacity = store->slot_capacity;
+    store->slots = slots;
+    store->slot_capacity = capacity;
+    store->sweep_cursor = 0;
+    
+    for (uint32_t i = 0; i < old_capacity; i++) {
+        if (old_slots[i].id == 0) continue;
+        uint32_t slot = qui_state_home(store, old_slots[i].id);
+        while (slots[slot].id != 0) slot = (slot + 1) & (capacity - 1);
+        slots[slot] = old_slots[i];
+    }
+    
+    QUI_FREE(old_slots);
+    return true;
+}
+
+/** @brief Remove a slot, shifting following entries back to keep probe chains intact */
+static void qui_state_remove_slot(qui_StateStore *store, uint32_t hole) {
+    uint32_t mask = store->slot_capacity - 1;
+    
+    qui_state_free_block(store, store->slots[hole].block);
+    store->live--;
+    
+    for (uint32_t next = (hole + 1) & mask; store->slots[next].id != 0; next = (next + 1) & mask) {
+        uint32_t home = qui_state_home(store, store->slots[next].id);
+        /* Entries whose home lies cyclically in (hole, next] must stay where they are */
+        bool stays = (hole <= next) ? (hole < home && home <= next) : (hole < home || home <= next);
+        if (stays) continue;
+        store->slots[hole] = store->slots[next];
+        hole = next;
+    }
+    store->slots[hole].id = 0;
+}
+
+/** @brief Evict states unused for longer than max_age, a slice of the table per frame */
+static void qui_state_collect(qui_Context *ctx) {
+    qui_StateStore *store = &ctx->state;
+    if (store->live == 0) return;
+    
+    uint32_t budget = store->slot_capacity / 16;
+    if (budget < 64) budget = 64;
+    if (budget > store->slot_capacity) budget = store->slot_capacity;
+    
+    for (uint32_t n = 0; n < budget; n++) {
+        uint32_t slot = store->sweep_cursor;
+        qui_StateSlot *s = &store->slots[slot];
+        if (s->id != 0 && ctx->frame_index - s->last_frame > store->max_age) {
+            /* Re-check this slot next iteration: removal may shift an entry into it */
+            qui_state_remove_slot(store, slot);
+            continue;
+        }
+        store->sweep_cursor = (slot + 1) & (store->slot_capacity - 1);
+    }
+}
+
+/** @brief Release all widget state memory */
+static void qui_state_release(qui_StateStore *store) {
+    for (uint32_t i = 0; i < store->chunk_count; i++) {
+        QUI_FREE(store->chunks[i]);
+    }
+    QUI_FREE(store->chunks);
+    QUI_FREE(store->slots);
+    memset(store, 0, sizeof(*store));
+    store->free_block = QUI_STATE_NO_BLOCK;
+    store->max_age = QUI_STATE_MAX_AGE;
 }
 
 /** @brief Check if point is inside rectangle (with layout offset) */
 static bool qui_hit_test(qui_Context *ctx, float x, float y, float w, float h) {
     if (!ctx) return false;
+    QUI_STAT_ADD(ctx, hit_tests, 1);
     
     float ox = ctx->layout_offset_x;
     float oy = ctx->layout_offset_y;
     int mx = ctx->mouse_pos.x;
     int my = ctx->mouse_pos.y;
     
+    /* Only the topmost window under the mouse (or the background, if none) gets input */
+    if (ctx->hover_window != ctx->current_window) {
+        return false;
+    }
+    
+    /* Clipped-away parts of a widget do not react to the mouse */
+    if (mx < ctx->clip.x0 || mx >= ctx->clip.x1 || my < ctx->clip.y0 || my >= ctx->clip.y1) {
+        return false;
+    }
+    
     return (mx >= x + ox && mx <= x + ox + w &&
             my >= y + oy && my <= y + oy + h);
 }
@@ -585,6 +2505,7 @@ static bool qui_hit_test(qui_Context *ctx, float x, float y, float w, float h) {
 /** @brief Check if point is inside rectangle (absolute coordinates) */
 static bool qui_hit_test_absolute(qui_Context *ctx, float x, float y, float w, float h) {
     if (!ctx) return false;
+    QUI_STAT_ADD(ctx, hit_tests, 1);
     
     int mx = ctx->mouse_pos.x;
     int my = ctx->mouse_pos.y;
@@ -593,12 +2514,175 @@ static bool qui_hit_test_absolute(qui_Context *ctx, float x, float y, float w, f
             my >= y && my <= y + h);
 }
 
+/** @brief Text cache associativity and entry flags */
+#define QUI_TEXT_CACHE_WAYS 4
+#define QUI_TEXT_CACHE_WIDTH  0x1u
+#define QUI_TEXT_CACHE_HEIGHT 0x2u
+
+/** @brief FNV-1a over raw bytes */
+static uint64_t qui_fnv1a64(uint64_t hash, const void *data, size_t size) {
+    const unsigned char *p = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= p[i];
+        hash *= 0x100000001B3ull;
+    }
+    return hash;
+}
+
+/** @brief Find or allocate the cache entry for a string in the current font */
+static qui_TextCacheEntry* qui_text_cache_entry(qui_Context *ctx, const char *text) {
+    qui_TextCache *cache = &ctx->text_cache;
+    
+    /* Key covers the font settings first, then the string content */
+    uint64_t key = 0xCBF29CE484222325ull;
+    key = qui_fnv1a64(key, &ctx->font, sizeof(ctx->font));
+    key = qui_fnv1a64(key, &ctx->font_size, sizeof(ctx->font_size));
+    key = qui_fnv1a64(key, &ctx->font_spacing, sizeof(ctx->font_spacing));
+    const unsigned char *p = (const unsigned char*)text;
+    for (; *p; p++) {
+        key ^= *p;
+        key *= 0x100000001B3ull;
+    }
+    if (key == 0) key = 1;
+    uint32_t length = (uint32_t)(p - (const unsigned char*)text);
+    
+    uint32_t set_count = QUI_TEXT_CACHE_SIZE / QUI_TEXT_CACHE_WAYS;
+    uint32_t set_index = (uint32_t)(key ^ (key >> 32)) & (set_count - 1);
+    qui_TextCacheEntry *set = &cache->entries[set_index * QUI_TEXT_CACHE_WAYS];
+    qui_TextCacheEntry *victim = &set[0];
+    cache->tick++;
+    
+    for (int way = 0; way < QUI_TEXT_CACHE_WAYS; way++) {
+        qui_TextCacheEntry *e = &set[way];
+        if (e->key == key && e->length == length) {
+            e->last_used = cache->tick;
+            return e;
+        }
+        if (victim->key != 0 && (e->key == 0 || e->last_used < victim->last_used)) {
+            victim = e;
+        }
+    }
+    
+    if (victim->key != 0) cache->evictions++;
+    victim->key = key;
+    victim->length = length;
+    victim->last_used = cache->tick;
+    victim->flags = 0;
+    return victim;
+}
+
+/** @brief Decode the next character for glyph lookup; sequences beyond Latin-1 return U+FFFD */
+static uint32_t qui_font_next_char(const unsigned char **text) {
+    const unsigned char *p = *text;
+    uint32_t c = *p++;
+    if (c >= 0x80) {
+        if ((c & 0xE0) == 0xC0 && (*p & 0xC0) == 0x80) {
+            c = ((c & 0x1F) << 6) | (*p++ & 0x3F);
+        } else {
+            c = 0xFFFD;
+        }
+        while ((*p & 0xC0) == 0x80) p++;
+    }
+    *text = p;
+    return c;
+}
+
+/** @brief Glyph for a code point, or the fallback glyph */
+static const qui_Glyph* qui_font_glyph(const qui_Font *font, uint32_t codepoint) {
+    if (codepoint < QUI_FONT_GLYPH_COUNT && font->glyphs[codepoint].defined) {
+        return &font->glyphs[codepoint];
+    }
+    return &font->glyphs[font->fallback];
+}
+
+/** @brief Sum of glyph advances */
+static float qui_font_text_width(const qui_Font *font, const char *text) {
+    float width = 0.0f;
+    const unsigned char *p = (const unsigned char*)text;
+    while (*p) {
+        width += qui_font_glyph(font, qui_font_next_char(&p))->advance;
+    }
+    return width;
+}
+
+/** @brief Sum of per-byte advances (plus kerning for each adjacent pair when hooked) */
+static float qui_table_text_width(qui_Context *ctx, const char *text) {
+    const float *advances = ctx->advance_table;
+    const unsigned char *p = (const unsigned char*)text;
+    size_t n = strlen(text);
+    size_t i = 0;
+    float width = 0.0f;
+    
+#ifdef QUI_SIMD_AVX2
+    __m256 sum8 = _mm256_setzero_ps();
+    for (; i + 8 <= n; i += 8) {
+        __m256i index = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(p + i)));
+        sum8 = _mm256_add_ps(sum8, _mm256_i32gather_ps(advances, index, 4));
+    }
+    __m128 sum4 = _mm_add_ps(_mm256_castps256_ps128(sum8), _mm256_extractf128_ps(sum8, 1));
+    sum4 = _mm_add_ps(sum4, _mm_movehl_ps(sum4, sum4));
+    sum4 = _mm_add_ss(sum4, _mm_shuffle_ps(sum4, sum4, 1));
+    width = _mm_cvtss_f32(sum4);
+#else
+    /* Independent partial sums keep the adds from serializing */
+    float s0 = 0.0f, s1 = 0.0f, s2 = 0.0f, s3 = 0.0f;
+    for (; i + 4 <= n; i += 4) {
+        s0 += advances[p[i]];
+        s1 += advances[p[i + 1]];
+        s2 += advances[p[i + 2]];
+        s3 += advances[p[i + 3]];
+    }
+    width = (s0 + s1) + (s2 + s3);
+#endif
+    for (; i < n; i++) width += advances[p[i]];
+    
+    if (ctx->kerning) {
+        for (i = 1; i < n; i++) width += ctx->kerning(ctx, p[i - 1], p[i]);
+    }
+    return width;
+}
+
 /** @brief Get text width with fallback */
 static float qui_get_text_width(qui_Context *ctx, const char *text) {
     if (!ctx || !text) return 0.0f;
     
+    if (ctx->atlas_font) {
+        return qui_font_text_width(ctx->atlas_font, text);
+    }
+    
+    /* A plain table sum is cheaper than hashing the string for the cache */
+    if (ctx->advance_table && !ctx->kerning) {
+        return qui_table_text_width(ctx, text);
+    }
+    
+    if (ctx->advance_table) {
+        qui_TextCacheEntry *e = qui_text_cache_entry(ctx, text);
+        if (e->flags & QUI_TEXT_CACHE_WIDTH) {
+            ctx->text_cache.hits++;
+            QUI_STAT_ADD(ctx, text_measures_cached, 1);
+            return e->width;
+        }
+        ctx->text_cache.misses++;
+        QUI_STAT_ADD(ctx, text_measures_uncached, 1);
+        e->width = qui_table_text_width(ctx, text);
+        e->flags |= QUI_TEXT_CACHE_WIDTH;
+        return e->width;
+    }
+    
     if (ctx->text_width) {
-        return ctx->text_width(ctx, text);
+        qui_TextCacheEntry *e = qui_text_cache_entry(ctx, text);
+        if (e->flags & QUI_TEXT_CACHE_WIDTH) {
+            ctx->text_cache.hits++;
+            QUI_STAT_ADD(ctx, text_measures_cached, 1);
+            return e->width;
+        }
+        ctx->text_cache.misses++;
+        QUI_STAT_ADD(ctx, text_measures_uncached, 1);
+        QUI_TRACE_PUSH(ctx, QUI_TRACE_BACKEND, "text_width");
+        e->width = ctx->text_width(ctx, text);
+        QUI_TRACE_POP(ctx);
+        e->flags |= QUI_TEXT_CACHE_WIDTH;
+        return e->width;
     }
     
     /* Fallback calculation */
@@ -609,47 +2693,1063 @@ static float qui_get_text_width(qui_Context *ctx, const char *text) {
 static float qui_get_text_height(qui_Context *ctx, const char *text) {
     if (!ctx || !text) return 0.0f;
     
+    if (ctx->atlas_font) {
+        return ctx->atlas_font->line_height;
+    }
+    
     if (ctx->text_height) {
-        return ctx->text_height(ctx, text);
+        qui_TextCacheEntry *e = qui_text_cache_entry(ctx, text);
+        if (e->flags & QUI_TEXT_CACHE_HEIGHT) {
+            ctx->text_cache.hits++;
+            QUI_STAT_ADD(ctx, text_measures_cached, 1);
+            return e->height;
+        }
+        ctx->text_cache.misses++;
+        QUI_STAT_ADD(ctx, text_measures_uncached, 1);
+        QUI_TRACE_PUSH(ctx, QUI_TRACE_BACKEND, "text_height");
+        e->height = ctx->text_height(ctx, text);
+        QUI_TRACE_POP(ctx);
+        e->flags |= QUI_TEXT_CACHE_HEIGHT;
+        return e->height;
     }
     
     /* Fallback calculation */
     return QUI_FALLBACK_TEXT_HEIGHT;
 }
 
+/** @brief Reserve the next command slot in the draw list */
+static qui_DrawCmd* qui_push_command(qui_Context *ctx, qui_CommandType type) {
+    qui_DrawList *list = &ctx->draw_list;
+    
+    if (list->count >= list->capacity) {
+        list->dropped++;
+        return NULL;
+    }
+    
+    qui_DrawCmd *cmd = &list->commands[list->count++];
+    memset(cmd, 0, sizeof(*cmd));
+    cmd->type = type;
+    return cmd;
+}
+
+/** @brief Bytes in front of the memory of an arena block (keeps the memory 16-byte aligned) */
+#define QUI_ARENA_HEADER ((sizeof(qui_ArenaBlock) + 15u) & ~(size_t)15u)
+
+/**
+ * @brief Continue the arena in a new block of at least min_size bytes
+ *
+ * The full block stays allocated, so everything handed out this frame remains valid.
+ */
+static bool qui_arena_push_block(qui_Arena *arena, size_t min_size) {
+    size_t capacity = (arena->capacity > min_size / 2) ? arena->capacity * 2 : min_size;
+    if (capacity < min_size || capacity > SIZE_MAX - QUI_ARENA_HEADER) return false;
+    
+    qui_ArenaBlock *block = (qui_ArenaBlock*)QUI_MALLOC(QUI_ARENA_HEADER + capacity);
+    if (!block) return false;
+    
+    if (arena->block) {
+        arena->block->used = arena->used;
+        arena->spilled += arena->used;
+    }
+    block->prev = arena->block;
+    block->used = 0;
+    arena->block = block;
+    arena->base = (unsigned char*)block + QUI_ARENA_HEADER;
+    arena->capacity = capacity;
+    arena->used = 0;
+    return true;
+}
+
+/** @brief Free every block of the arena */
+static void qui_arena_release(qui_Arena *arena) {
+    qui_ArenaBlock *block = arena->block;
+    while (block) {
+        qui_ArenaBlock *prev = block->prev;
+        QUI_FREE(block);
+        block = prev;
+    }
+    arena->block = NULL;
+    arena->base = NULL;
+    arena->capacity = 0;
+}
+
+/** @brief Start a frame; if the last one spilled into several blocks, keep one block that fits it */
+static void qui_arena_reset(qui_Arena *arena) {
+    qui_ArenaBlock *block = arena->block;
+    if (block && block->prev) {
+        size_t total = arena->spilled + arena->used;
+        qui_ArenaBlock *old = block->prev;
+        block->prev = NULL;
+        while (old) {
+            qui_ArenaBlock *prev = old->prev;
+            QUI_FREE(old);
+            old = prev;
+        }
+        
+        /* Out of memory: keep the current block and spill again next frame */
+        if (arena->capacity < total) {
+            qui_Arena resized;
+            memset(&resized, 0, sizeof(resized));
+            resized.capacity = arena->capacity;
+            if (qui_arena_push_block(&resized, total)) {
+                QUI_FREE(block);
+                arena->block = resized.block;
+                arena->base = resized.base;
+                arena->capacity = resized.capacity;
+            }
+        }
+    }
+    arena->used = 0;
+    arena->spilled = 0;
+    arena->failures = 0;
+}
+
+/** @brief Check whether a pointer lies inside this frame's arena allocations */
+static bool qui_arena_owns(const qui_Arena *arena, const void *ptr) {
+    const unsigned char *p = (const unsigned char*)ptr;
+    if (arena->base && p >= arena->base && p < arena->base + arena->used) return true;
+    
+    /* Blocks filled earlier in the frame (rare: only frames that outgrew the arena) */
+    const qui_ArenaBlock *block = arena->block ? arena->block->prev : NULL;
+    for (; block; block = block->prev) {
+        const unsigned char *base = (const unsigned char*)block + QUI_ARENA_HEADER;
+        if (p >= base && p < base + block->used) return true;
+    }
+    return false;
+}
+
+/** @brief Mix one primitive into the frame output hash and the current widget record */
+static void qui_hash_primitive(qui_Context *ctx, qui_CommandType type, float x, float y, const qui_ClipRect *visible,
+                               qui_Color32 color, const void *extra, size_t extra_size) {
+    float geometry[6] = {x, y, visible->x0, visible->y0, visible->x1, visible->y1};
+    uint64_t hash = 0xCBF29CE484222325ull;
+    hash = qui_fnv1a64(hash, &type, sizeof(type));
+    hash = qui_fnv1a64(hash, geometry, sizeof(geometry));
+    hash = qui_fnv1a64(hash, &color, sizeof(color));
+    hash = qui_fnv1a64(hash, extra, extra_size);
+    ctx->frame_hash = qui_fnv1a64(ctx->frame_hash, &hash, sizeof(hash));
+    
+    if (ctx->damage.enabled && ctx->damage.count > 0) {
+        qui_WidgetRecord *rec = &ctx->damage.records[ctx->damage.count - 1];
+        rec->hash = qui_fnv1a64(rec->hash, &hash, sizeof(hash));
+        if (visible->x0 < rec->x0) rec->x0 = visible->x0;
+        if (visible->y0 < rec->y0) rec->y0 = visible->y0;
+        if (visible->x1 > rec->x1) rec->x1 = visible->x1;
+        if (visible->y1 > rec->y1) rec->y1 = visible->y1;
+    }
+}
+
+/** @brief Mix extra state that affects the output (such as stacking order) into the current widget record */
+static void qui_hash_value(qui_Context *ctx, const void *data, size_t size) {
+    ctx->frame_hash = qui_fnv1a64(ctx->frame_hash, data, size);
+    if (ctx->damage.enabled && ctx->damage.count > 0) {
+        qui_WidgetRecord *rec = &ctx->damage.records[ctx->damage.count - 1];
+        rec->hash = qui_fnv1a64(rec->hash, data, size);
+    }
+}
+
+/** @brief Clip rectangle that lets everything through */
+static const qui_ClipRect QUI_CLIP_NONE = {-1e30f, -1e30f, 1e30f, 1e30f};
+
+/** @brief Intersect bounds with the current clip; false if nothing is left */
+static bool qui_clip_bounds(const qui_Context *ctx, const qui_ClipRect *bounds, qui_ClipRect *visible) {
+    visible->x0 = (bounds->x0 > ctx->clip.x0) ? bounds->x0 : ctx->clip.x0;
+    visible->y0 = (bounds->y0 > ctx->clip.y0) ? bounds->y0 : ctx->clip.y0;
+    visible->x1 = (bounds->x1 < ctx->clip.x1) ? bounds->x1 : ctx->clip.x1;
+    visible->y1 = (bounds->y1 < ctx->clip.y1) ? bounds->y1 : ctx->clip.y1;
+    return visible->x0 < visible->x1 && visible->y0 < visible->y1;
+}
+
+/** @brief Send a scissor change to the backend or the draw list (NULL disables it) */
+static void qui_emit_clip(qui_Context *ctx, const qui_ClipRect *clip) {
+    ctx->backend_clip_set = (clip != NULL);
+    if (clip) ctx->backend_clip = *clip;
+    
+    /* Backends get whole pixels, rounded outward */
+    qui_Rect rect = qui_rect(-1, -1, 0, 0);
+    if (clip) {
+        int x0 = (int)floorf(clip->x0);
+        int y0 = (int)floorf(clip->y0);
+        rect = qui_rect((int)ceilf(clip->x1) - x0, (int)ceilf(clip->y1) - y0, x0, y0);
+    }
+    
+    QUI_STAT_ADD(ctx, set_clip_calls, 1);
+    if (ctx->draw_list_enabled) {
+        qui_DrawCmd *cmd = qui_push_command(ctx, QUI_COMMAND_CLIP);
+        if (!cmd) return;
+        cmd->x = (float)rect.pos_x;
+        cmd->y = (float)rect.pos_y;
+        cmd->w = (float)rect.width;
+        cmd->h = (float)rect.height;
+        return;
+    }
+    
+    if (!ctx->set_clip) return;
+    
+    QUI_TRACE_PUSH(ctx, QUI_TRACE_BACKEND, "set_clip");
+    ctx->set_clip(ctx, clip ? &rect : NULL);
+    QUI_TRACE_POP(ctx);
+}
+
+/**
+ * @brief Bring the backend scissor in line with a primitive about to be drawn
+ * 
+ * Primitives that cross the clip edge need the current clip as scissor. Primitives
+ * already inside it only need a scissor that does not cut them, so the scissor
+ * is left alone while possible to keep state changes rare.
+ */
+static void qui_sync_clip(qui_Context *ctx, const qui_ClipRect *bounds, bool crosses_clip) {
+    const qui_ClipRect *b = &ctx->backend_clip;
+    
+    if (crosses_clip) {
+        if (!ctx->backend_clip_set || memcmp(b, &ctx->clip, sizeof(*b)) != 0) {
+            qui_emit_clip(ctx, &ctx->clip);
+        }
+        return;
+    }
+    
+    if (ctx->backend_clip_set &&
+        (bounds->x0 < b->x0 || bounds->y0 < b->y0 || bounds->x1 > b->x1 || bounds->y1 > b->y1)) {
+        qui_emit_clip(ctx, (ctx->clip_depth > 0) ? &ctx->clip : NULL);
+    }
+}
+
 /** @brief Draw rectangle with error checking */
-static void qui_draw_rect_safe(qui_Context *ctx, qui_Rect *rect, qui_Color color) {
-    if (!ctx || !rect || !ctx->draw_rect) return;
+static void qui_draw_rect_safe(qui_Context *ctx, qui_Rect *rect, qui_Color32 color) {
+    if (!ctx || !rect) return;
+    
+    float x = rect->pos_x + ctx->layout_offset_x;
+    float y = rect->pos_y + ctx->layout_offset_y;
+    qui_ClipRect bounds = {x, y, x + (float)rect->width, y + (float)rect->height};
+    qui_ClipRect visible;
+    
+    /* Rectangles are clipped geometrically, so they never need a scissor */
+    if (!qui_clip_bounds(ctx, &bounds, &visible)) return;
+    qui_sync_clip(ctx, &visible, false);
+    qui_hash_primitive(ctx, QUI_COMMAND_RECT, visible.x0, visible.y0, &visible, color, NULL, 0);
+    
+    float w = visible.x1 - visible.x0;
+    float h = visible.y1 - visible.y0;
+    QUI_STAT_ADD(ctx, draw_rect_calls, 1);
+    
+    if (ctx->draw_list_enabled) {
+        qui_DrawCmd *cmd = qui_push_command(ctx, QUI_COMMAND_RECT);
+        if (!cmd) return;
+        cmd->x = visible.x0;
+        cmd->y = visible.y0;
+        cmd->w = w;
+        cmd->h = h;
+        cmd->color = color;
+        return;
+    }
     
-    float ox = ctx->layout_offset_x;
-    float oy = ctx->layout_offset_y;
+    if (!ctx->draw_rect) return;
     
-    ctx->draw_rect(ctx,
-                   rect->pos_x + ox,
-                   rect->pos_y + oy,
-                   rect->width,
-                   rect->height,
-                   color);
+    QUI_TRACE_PUSH(ctx, QUI_TRACE_BACKEND, "draw_rect");
+    ctx->draw_rect(ctx, visible.x0, visible.y0, w, h, qui_unpack_color(color));
+    QUI_TRACE_POP(ctx);
 }
 
 /** @brief Draw text with error checking */
 static void qui_draw_text_safe(qui_Context *ctx, const char *text, float x, float y) {
-    if (!ctx || !text || !ctx->draw_text) return;
+    if (!ctx || !text) return;
     
-    float ox = ctx->layout_offset_x;
-    float oy = ctx->layout_offset_y;
+    x += ctx->layout_offset_x;
+    y += ctx->layout_offset_y;
+    
+    /* Text bounds are only needed (and only measured) for clipping and damage tracking */
+    float tw = 0.0f;
+    float th = 0.0f;
+    if (ctx->clip_depth > 0 || ctx->damage.enabled) {
+        tw = qui_get_text_width(ctx, text);
+        th = qui_get_text_height(ctx, text);
+    }
+    qui_ClipRect bounds = {x, y, x + tw, y + th};
+    qui_ClipRect visible = bounds;
+    
+    if (ctx->clip_depth > 0) {
+        if (!qui_clip_bounds(ctx, &bounds, &visible)) return;
+        qui_sync_clip(ctx, &bounds, memcmp(&bounds, &visible, sizeof(bounds)) != 0);
+    } else if (ctx->backend_clip_set) {
+        qui_emit_clip(ctx, NULL);
+    }
+    size_t length = strlen(text);
+    qui_hash_primitive(ctx, QUI_COMMAND_TEXT, x, y, &visible,
+                       ctx->colors[QUI_COLOR_TEXT], text, length);
+    QUI_STAT_ADD(ctx, draw_text_calls, 1);
+    
+    if (ctx->draw_list_enabled) {
+        /* The string must outlive the widget call; arena strings already do */
+        const char *copy = qui_arena_owns(&ctx->frame_arena, text) ? text : qui_frame_strndup(ctx, text, length);
+        if (!copy) {
+            ctx->draw_list.dropped++;
+            return;
+        }
+        qui_DrawCmd *cmd = qui_push_command(ctx, QUI_COMMAND_TEXT);
+        if (!cmd) return;
+        cmd->x = x;
+        cmd->y = y;
+        cmd->w = tw;
+        cmd->h = th;
+        cmd->color = ctx->colors[QUI_COLOR_TEXT];
+        cmd->text = copy;
+        return;
+    }
     
-    ctx->draw_text(ctx, text, x + ox, y + oy);
+    if (!ctx->draw_text) return;
+    
+    QUI_TRACE_PUSH(ctx, QUI_TRACE_BACKEND, "draw_text");
+    ctx->draw_text(ctx, text, x, y);
+    QUI_TRACE_POP(ctx);
 }
 
 /** @brief Draw image with error checking */
 static void qui_draw_image_safe(qui_Context *ctx, qui_Image *image, float x, float y, float w, float h) {
-    if (!ctx || !image || !ctx->draw_image) return;
+    if (!ctx || !image) return;
+    
+    x += ctx->layout_offset_x;
+    y += ctx->layout_offset_y;
+    qui_ClipRect bounds = {x, y, x + w, y + h};
+    qui_ClipRect visible;
+    
+    /* Images keep their texture mapping; partly hidden ones are cut by the scissor */
+    if (!qui_clip_bounds(ctx, &bounds, &visible)) return;
+    qui_sync_clip(ctx, &bounds, memcmp(&bounds, &visible, sizeof(bounds)) != 0);
+    
+    qui_Color32 white = QUI_RGBA(255, 255, 255, 255);
+    qui_hash_primitive(ctx, QUI_COMMAND_IMAGE, x, y, &visible, white, &image, sizeof(image));
+    QUI_STAT_ADD(ctx, draw_image_calls, 1);
+    
+    if (ctx->draw_list_enabled) {
+        qui_DrawCmd *cmd = qui_push_command(ctx, QUI_COMMAND_IMAGE);
+        if (!cmd) return;
+        cmd->x = x;
+        cmd->y = y;
+        cmd->w = w;
+        cmd->h = h;
+        cmd->image = image;
+        return;
+    }
     
-    float ox = ctx->layout_offset_x;
-    float oy = ctx->layout_offset_y;
+    if (!ctx->draw_image) return;
+    
+    QUI_TRACE_PUSH(ctx, QUI_TRACE_BACKEND, "draw_image");
+    ctx->draw_image(ctx, image, x, y, w, h);
+    QUI_TRACE_POP(ctx);
+}
+
+/** @brief Background color for a widget's state: active, hot or idle */
+static qui_Color32 qui_state_color(const qui_Context *ctx, qui_Id id) {
+    /* One table load indexed by state instead of a copy per branch */
+    int slot = (ctx->active_id == id) ? QUI_COLOR_ACTIVE : (ctx->hot_id == id) ? QUI_COLOR_HOT : QUI_COLOR_FOREGROUND;
+    return ctx->colors[slot];
+}
+
+/**
+ * @brief Cull a widget that lies entirely outside the current clip
+ * 
+ * A culled widget is not drawn or hit-tested. If it was active when the mouse was
+ * released, it lets go so the release is not lost while it is out of view.
+ */
+static bool qui_cull_widget(qui_Context *ctx, qui_Id id, float x, float y, float w, float h) {
+    if (ctx->clip_depth == 0) return false;
+    
+    float ax = x + ctx->layout_offset_x;
+    float ay = y + ctx->layout_offset_y;
+    if (ax < ctx->clip.x1 && ax + w > ctx->clip.x0 && ay < ctx->clip.y1 && ay + h > ctx->clip.y0) {
+        return false;
+    }
+    
+    if (ctx->mouse_released && ctx->active_id == id) {
+        ctx->active_id = 0;
+    }
+    QUI_STAT_ADD(ctx, widgets_culled, 1);
+    return true;
+}
+
+/** @brief Push a clip rectangle in screen coordinates, intersected with the current clip */
+static bool qui_push_clip_absolute(qui_Context *ctx, const qui_ClipRect *rect) {
+    if (ctx->clip_depth >= QUI_CLIP_STACK_SIZE) return false;
+    
+    ctx->clip_stack[ctx->clip_depth++] = ctx->clip;
+    if (!qui_clip_bounds(ctx, rect, &ctx->clip)) {
+        /* Nothing visible: keep an empty rectangle that rejects everything */
+        ctx->clip.x1 = ctx->clip.x0;
+        ctx->clip.y1 = ctx->clip.y0;
+    }
+    return true;
+}
+
+/** @brief Add a changed region, merging it with overlapping damage rectangles */
+static void qui_damage_push_rect(qui_DamageTracker *d, float fx0, float fy0, float fx1, float fy1) {
+    if (fx1 <= fx0 || fy1 <= fy0) return;
+    
+    int x0 = (int)floorf(fx0);
+    int y0 = (int)floorf(fy0);
+    int x1 = (int)ceilf(fx1);
+    int y1 = (int)ceilf(fy1);
+    
+    /* Absorb every rectangle that touches the new one */
+    for (int i = 0; i < d->rect_count; i++) {
+        qui_Rect *r = &d->rects[i];
+        if (r->pos_x > x1 || r->pos_x + r->width < x0 || r->pos_y > y1 || r->pos_y + r->height < y0) continue;
+        if (r->pos_x < x0) x0 = r->pos_x;
+        if (r->pos_y < y0) y0 = r->pos_y;
+        if (r->pos_x + r->width > x1) x1 = r->pos_x + r->width;
+        if (r->pos_y + r->height > y1) y1 = r->pos_y + r->height;
+        d->rects[i] = d->rects[--d->rect_count];
+        i = -1;
+    }
+    
+    if (d->rect_count < QUI_MAX_DAMAGE_RECTS) {
+        d->rects[d->rect_count++] = qui_rect(x1 - x0, y1 - y0, x0, y0);
+        return;
+    }
+    
+    /* List full: grow the rectangle whose area increases least */
+    int best = 0;
+    double best_growth = 0.0;
+    for (int i = 0; i < d->rect_count; i++) {
+        qui_Rect *r = &d->rects[i];
+        int ux0 = r->pos_x < x0 ? r->pos_x : x0;
+        int uy0 = r->pos_y < y0 ? r->pos_y : y0;
+        int ux1 = r->pos_x + r->width > x1 ? r->pos_x + r->width : x1;
+        int uy1 = r->pos_y + r->height > y1 ? r->pos_y + r->height : y1;
+        double growth = (double)(ux1 - ux0) * (uy1 - uy0) - (double)r->width * r->height;
+        if (i == 0 || growth < best_growth) {
+            best = i;
+            best_growth = growth;
+        }
+    }
+    qui_Rect *r = &d->rects[best];
+    int ux0 = r->pos_x < x0 ? r->pos_x : x0;
+    int uy0 = r->pos_y < y0 ? r->pos_y : y0;
+    int ux1 = r->pos_x + r->width > x1 ? r->pos_x + r->width : x1;
+    int uy1 = r->pos_y + r->height > y1 ? r->pos_y + r->height : y1;
+    *r = qui_rect(ux1 - ux0, uy1 - uy0, ux0, uy0);
+}
+
+/** @brief Damage the bounds of one widget record */
+static void qui_damage_push_record(qui_DamageTracker *d, const qui_WidgetRecord *rec) {
+    qui_damage_push_rect(d, rec->x0, rec->y0, rec->x1, rec->y1);
+}
+
+/** @brief Compare this frame's widget records with the previous frame and collect damage */
+static void qui_damage_finish(qui_Context *ctx) {
+    qui_DamageTracker *d = &ctx->damage;
+    const qui_WidgetRecord *cur = d->records;
+    const qui_WidgetRecord *prev = d->previous;
+    int n = d->count;
+    int pn = d->previous_count;
+    
+    d->rect_count = 0;
+    
+    /* Fast path: widgets usually come in the same order as last frame */
+    int i = 0;
+    for (; i < n && i < pn && cur[i].id == prev[i].id; i++) {
+        if (cur[i].hash != prev[i].hash) {
+            qui_damage_push_record(d, &prev[i]);
+            qui_damage_push_record(d, &cur[i]);
+        }
+    }
+    
+    if (i < n || i < pn) {
+        /* Order changed: index the rest of last frame by ID in scratch memory */
+        uint32_t slots = 16;
+        while (slots < (uint32_t)(pn - i) * 2) slots *= 2;
+        int32_t *index = (int32_t*)qui_frame_alloc(ctx, sizeof(int32_t) * slots);
+        unsigned char *matched = (unsigned char*)qui_frame_alloc(ctx, (size_t)(pn - i) + 1);
+        
+        if (!index || !matched) {
+            /* No scratch memory: damage everything that is left */
+            for (int j = i; j < n; j++) qui_damage_push_record(d, &cur[j]);
+            for (int k = i; k < pn; k++) qui_damage_push_record(d, &prev[k]);
+        } else {
+            memset(index, 0xFF, sizeof(int32_t) * slots);
+            memset(matched, 0, (size_t)(pn - i) + 1);
+            for (int k = i; k < pn; k++) {
+                uint32_t slot = (prev[k].id * 0x9E3779B1u) & (slots - 1);
+                while (index[slot] >= 0) slot = (slot + 1) & (slots - 1);
+                index[slot] = k;
+            }
+            
+            for (int j = i; j < n; j++) {
+                uint32_t slot = (cur[j].id * 0x9E3779B1u) & (slots - 1);
+                int found = -1;
+                for (; index[slot] >= 0; slot = (slot + 1) & (slots - 1)) {
+                    if (prev[index[slot]].id == cur[j].id && !matched[index[slot] - i]) {
+                        found = index[slot];
+                        break;
+                    }
+                }
+                if (found < 0) {
+                    qui_damage_push_record(d, &cur[j]);
+                    continue;
+                }
+                matched[found - i] = 1;
+                if (prev[found].hash != cur[j].hash) {
+                    qui_damage_push_record(d, &prev[found]);
+                    qui_damage_push_record(d, &cur[j]);
+                }
+            }
+            
+            /* Widgets that disappeared leave damage where they were */
+            for (int k = i; k < pn; k++) {
+                if (!matched[k - i]) qui_damage_push_record(d, &prev[k]);
+            }
+        }
+    }
+    
+    /* This frame becomes the reference for the next one */
+    qui_WidgetRecord *swap = d->previous;
+    int swap_capacity = d->previous_capacity;
+    d->previous = d->records;
+    d->previous_count = d->count;
+    d->previous_capacity = d->capacity;
+    d->records = swap;
+    d->capacity = swap_capacity;
+    d->count = 0;
+}
+
+/** @brief Find a window in the z-ordered window list, -1 if unknown */
+static int qui_find_window(const qui_Context *ctx, qui_Id id) {
+    for (int i = 0; i < ctx->window_count; i++) {
+        if (ctx->windows[i].id == id) return i;
+    }
+    return -1;
+}
+
+/** @brief Move a window to the top of the stacking order */
+static void qui_raise_window(qui_Context *ctx, int index) {
+    qui_WindowEntry entry = ctx->windows[index];
+    memmove(&ctx->windows[index], &ctx->windows[index + 1],
+            sizeof(qui_WindowEntry) * (size_t)(ctx->window_count - index - 1));
+    ctx->windows[ctx->window_count - 1] = entry;
+}
+
+/** @brief Forget windows that were not shown last frame and find the window under the mouse */
+static void qui_update_windows(qui_Context *ctx) {
+    int kept = 0;
+    for (int i = 0; i < ctx->window_count; i++) {
+        if (ctx->frame_index - ctx->windows[i].last_frame <= 1u) {
+            ctx->windows[kept++] = ctx->windows[i];
+        }
+    }
+    ctx->window_count = kept;
+    
+    /* Resolve hover once, against last frame's rects, from the top down */
+    ctx->hover_window = 0;
+    float mx = (float)ctx->mouse_pos.x;
+    float my = (float)ctx->mouse_pos.y;
+    for (int i = ctx->window_count - 1; i >= 0; i--) {
+        const qui_WindowEntry *win = &ctx->windows[i];
+        if (mx >= win->x && mx <= win->x + win->w && my >= win->y && my <= win->y + win->h) {
+            ctx->hover_window = win->id;
+            /* A click brings the window to the front before anything is drawn */
+            if (ctx->mouse_pressed && i != ctx->window_count - 1) {
+                qui_raise_window(ctx, i);
+            }
+            break;
+        }
+    }
+}
+
+/**
+ * @brief End the draw list run of the current window and start one for another
+ * 
+ * Each run starts and ends without a backend scissor so runs can be reordered.
+ */
+static void qui_switch_segment(qui_Context *ctx, qui_Id next_window) {
+    if (ctx->backend_clip_set) {
+        qui_emit_clip(ctx, NULL);
+    }
+    
+    if (ctx->draw_list_enabled && ctx->draw_list.count > ctx->segment_start) {
+        if (ctx->segment_count < (int)(sizeof(ctx->draw_segments) / sizeof(ctx->draw_segments[0]))) {
+            qui_DrawSegment *seg = &ctx->draw_segments[ctx->segment_count++];
+            seg->window = ctx->current_window;
+            seg->start = ctx->segment_start;
+            seg->end = ctx->draw_list.count;
+        } else {
+            ctx->segments_overflow = true;
+        }
+    }
+    
+    ctx->segment_start = ctx->draw_list.count;
+    ctx->current_window = next_window;
+}
+
+/** @brief Copy every run of one window to the output, in submission order */
+static qui_DrawCmd* qui_copy_segments(const qui_Context *ctx, qui_Id window, qui_DrawCmd *out) {
+    for (int i = 0; i < ctx->segment_count; i++) {
+        const qui_DrawSegment *seg = &ctx->draw_segments[i];
+        if (seg->window != window) continue;
+        memcpy(out, &ctx->draw_list.commands[seg->start], sizeof(qui_DrawCmd) * (size_t)(seg->end - seg->start));
+        out += seg->end - seg->start;
+    }
+    return out;
+}
+
+/** @brief Reorder the draw list so windows come out back to front */
+static void qui_sort_draw_list(qui_Context *ctx) {
+    qui_DrawList *list = &ctx->draw_list;
+    if (ctx->window_count == 0 || ctx->segments_overflow || list->count == 0) return;
+    
+    qui_DrawCmd *sorted = (qui_DrawCmd*)qui_frame_alloc(ctx, sizeof(qui_DrawCmd) * (size_t)list->count);
+    if (!sorted) return;
+    
+    qui_DrawCmd *out = qui_copy_segments(ctx, 0, sorted);
+    for (int i = 0; i < ctx->window_count; i++) {
+        out = qui_copy_segments(ctx, ctx->windows[i].id, out);
+    }
+    
+    /* Runs of windows missing from the list go on top, in submission order */
+    for (int i = 0; i < ctx->segment_count; i++) {
+        const qui_DrawSegment *seg = &ctx->draw_segments[i];
+        if (seg->window == 0 || qui_find_window(ctx, seg->window) >= 0) continue;
+        memcpy(out, &list->commands[seg->start], sizeof(qui_DrawCmd) * (size_t)(seg->end - seg->start));
+        out += seg->end - seg->start;
+    }
+    
+    int copied = (int)(out - sorted);
+    if (copied != list->count) return;
+    memcpy(list->commands, sorted, sizeof(qui_DrawCmd) * (size_t)list->count);
+}
+
+/** @brief Save the layout before entering a window or scroll region */
+static bool qui_push_layout(qui_Context *ctx) {
+    if (ctx->layout_depth >= QUI_LAYOUT_STACK_SIZE) return false;
+    
+    qui_LayoutFrame *frame = &ctx->layout_stack[ctx->layout_depth++];
+    frame->cursor_x = ctx->cursor_x;
+    frame->cursor_y = ctx->cursor_y;
+    frame->offset_x = ctx->layout_offset_x;
+    frame->offset_y = ctx->layout_offset_y;
+    frame->start_x = ctx->layout_start_x;
+    frame->content_width = ctx->content_width;
+    frame->window = ctx->current_window;
+    frame->row = ctx->row;
+    ctx->row.active = false;
+    return true;
+}
+
+/** @brief Restore the layout saved by the matching qui_push_layout() */
+static qui_LayoutFrame* qui_pop_layout(qui_Context *ctx) {
+    if (ctx->layout_depth <= 0) return NULL;
+    
+    qui_LayoutFrame *frame = &ctx->layout_stack[--ctx->layout_depth];
+    ctx->cursor_x = frame->cursor_x;
+    ctx->cursor_y = frame->cursor_y;
+    ctx->layout_offset_x = frame->offset_x;
+    ctx->layout_offset_y = frame->offset_y;
+    ctx->layout_start_x = frame->start_x;
+    ctx->content_width = frame->content_width;
+    ctx->row = frame->row;
+    return frame;
+}
+
+/** @brief Position of the next widget: the column cursor, or the next cell of the row layout */
+static void qui_layout_next(qui_Context *ctx, float w, float h, float *x, float *y) {
+    qui_RowLayout *row = &ctx->row;
+    if (!row->active) {
+        *x = ctx->cursor_x;
+        *y = ctx->cursor_y;
+        return;
+    }
+    
+    float free_x = row->widths[row->column] - w;
+    float free_y = row->cached_height - h;
+    *x = row->cell_x;
+    *y = row->y;
+    if (free_x > 0.0f && row->align_x != QUI_ALIGN_START) {
+        *x += (row->align_x == QUI_ALIGN_CENTER) ? free_x * 0.5f : free_x;
+    }
+    if (free_y > 0.0f && row->align_y != QUI_ALIGN_START) {
+        *y += (row->align_y == QUI_ALIGN_CENTER) ? free_y * 0.5f : free_y;
+    }
+}
+
+/** @brief Start a new row of cells below the current one */
+static void qui_layout_wrap(qui_Context *ctx) {
+    qui_RowLayout *row = &ctx->row;
+    if (row->row_height > row->measured_height) row->measured_height = row->row_height;
+    row->y += row->row_height + ctx->spacing_y;
+    row->row_height = 0.0f;
+    row->column = 0;
+    row->cell_x = row->x;
+}
+
+/** @brief Move the layout past a widget of the given size, measuring it for auto columns */
+static void qui_layout_advance(qui_Context *ctx, float w, float h) {
+    qui_RowLayout *row = &ctx->row;
+    if (!row->active) {
+        ctx->cursor_y += h + ctx->spacing_y;
+        ctx->cursor_x = ctx->layout_start_x;
+        return;
+    }
+    
+    if (w > row->measured[row->column]) row->measured[row->column] = w;
+    if (h > row->row_height) row->row_height = h;
+    row->cell_x += row->widths[row->column] + ctx->spacing_x;
+    if (++row->column >= row->columns) {
+        qui_layout_wrap(ctx);
+    }
+    ctx->cursor_x = row->cell_x;
+    ctx->cursor_y = row->y;
+}
+
+/** @brief Largest hit grid dimension (the grid has at most this squared cells) */
+#define QUI_HIT_GRID_MAX_DIM 128
+
+/** @brief Grow a heap array to hold at least need elements */
+static bool qui_grow_array(void **ptr, int *capacity, int need, size_t elem_size) {
+    if (need <= *capacity) return true;
+    
+    int new_capacity = *capacity ? *capacity : 64;
+    while (new_capacity < need) new_capacity *= 2;
+    void *grown = QUI_REALLOC(*ptr, elem_size * (size_t)new_capacity);
+    if (!grown) return false;
+    *ptr = grown;
+    *capacity = new_capacity;
+    return true;
+}
+
+/** @brief Record a widget's visible hit rectangle in screen coordinates */
+static void qui_record_hit(qui_Context *ctx, qui_Id id, float x, float y, float w, float h) {
+    qui_ClipRect bounds = {x, y, x + w, y + h};
+    qui_ClipRect visible;
+    if (!qui_clip_bounds(ctx, &bounds, &visible)) return;
+    
+    qui_HitIndex *hi = &ctx->hit_index;
+    if (!qui_grow_array((void**)&hi->records, &hi->capacity, hi->count + 1, sizeof(qui_HitRecord))) return;
+    
+    qui_HitRecord *rec = &hi->records[hi->count++];
+    rec->id = id;
+    rec->window = ctx->current_window;
+    rec->x0 = visible.x0;
+    rec->y0 = visible.y0;
+    rec->x1 = visible.x1;
+    rec->y1 = visible.y1;
+}
+
+/** @brief Record a widget's hit rectangle and report whether it is under the mouse */
+static bool qui_widget_hovered(qui_Context *ctx, qui_Id id, float x, float y, float w, float h) {
+    qui_record_hit(ctx, id, x + ctx->layout_offset_x, y + ctx->layout_offset_y, w, h);
+    QUI_STAT_ADD(ctx, hit_tests, 1);
+    return id != 0 && ctx->hover_id == id;
+}
+
+/** @brief Grid cell range covered by a rectangle */
+static void qui_hit_cells(const qui_HitIndex *hi, const qui_HitRecord *rec, int *cx0, int *cy0, int *cx1, int *cy1) {
+    *cx0 = (int)((rec->x0 - hi->origin_x) * hi->inv_cell_w);
+    *cy0 = (int)((rec->y0 - hi->origin_y) * hi->inv_cell_h);
+    *cx1 = (int)((rec->x1 - hi->origin_x) * hi->inv_cell_w);
+    *cy1 = (int)((rec->y1 - hi->origin_y) * hi->inv_cell_h);
+    if (*cx0 >= hi->cols) *cx0 = hi->cols - 1;
+    if (*cy0 >= hi->rows) *cy0 = hi->rows - 1;
+    if (*cx1 >= hi->cols) *cx1 = hi->cols - 1;
+    if (*cy1 >= hi->rows) *cy1 = hi->rows - 1;
+}
+
+/** @brief Build the hover grid from this frame's hit rectangles, in stacking order */
+static void qui_hit_index_build(qui_Context *ctx) {
+    qui_HitIndex *hi = &ctx->hit_index;
+    int n = hi->count;
+    
+    hi->cols = 0;
+    hi->rows = 0;
+    hi->entry_count = 0;
+    if (n == 0) return;
+    
+    float bx0 = hi->records[0].x0, by0 = hi->records[0].y0;
+    float bx1 = hi->records[0].x1, by1 = hi->records[0].y1;
+    for (int i = 1; i < n; i++) {
+        const qui_HitRecord *rec = &hi->records[i];
+        if (rec->x0 < bx0) bx0 = rec->x0;
+        if (rec->y0 < by0) by0 = rec->y0;
+        if (rec->x1 > bx1) bx1 = rec->x1;
+        if (rec->y1 > by1) by1 = rec->y1;
+    }
+    
+    /* Aim for about one rectangle per cell */
+    float width = fmaxf(bx1 - bx0, 1.0f);
+    float height = fmaxf(by1 - by0, 1.0f);
+    float cell = sqrtf(width * height / (float)n);
+    int cols = (int)ceilf(width / cell);
+    int rows = (int)ceilf(height / cell);
+    if (cols < 1) cols = 1;
+    if (rows < 1) rows = 1;
+    if (cols > QUI_HIT_GRID_MAX_DIM) cols = QUI_HIT_GRID_MAX_DIM;
+    if (rows > QUI_HIT_GRID_MAX_DIM) rows = QUI_HIT_GRID_MAX_DIM;
+    int cells = cols * rows;
+    
+    if (!qui_grow_array((void**)&hi->cell_start, &hi->cell_capacity, cells + 1, sizeof(int))) return;
+    hi->cols = cols;
+    hi->rows = rows;
+    hi->origin_x = bx0;
+    hi->origin_y = by0;
+    hi->inv_cell_w = (float)cols / width;
+    hi->inv_cell_h = (float)rows / height;
+    memset(hi->cell_start, 0, sizeof(int) * (size_t)(cells + 1));
+    
+    /* Count entries per cell, then turn the counts into start offsets */
+    int total = 0;
+    for (int i = 0; i < n; i++) {
+        int cx0, cy0, cx1, cy1;
+        qui_hit_cells(hi, &hi->records[i], &cx0, &cy0, &cx1, &cy1);
+        for (int cy = cy0; cy <= cy1; cy++) {
+            for (int cx = cx0; cx <= cx1; cx++) {
+                hi->cell_start[cy * cols + cx]++;
+            }
+        }
+        total += (cx1 - cx0 + 1) * (cy1 - cy0 + 1);
+    }
+    
+    int capacity = hi->entry_capacity;
+    bool grown = qui_grow_array((void**)&hi->x0, &capacity, total, sizeof(float));
+    capacity = hi->entry_capacity;
+    grown = grown && qui_grow_array((void**)&hi->y0, &capacity, total, sizeof(float));
+    capacity = hi->entry_capacity;
+    grown = grown && qui_grow_array((void**)&hi->x1, &capacity, total, sizeof(float));
+    capacity = hi->entry_capacity;
+    grown = grown && qui_grow_array((void**)&hi->y1, &capacity, total, sizeof(float));
+    capacity = hi->entry_capacity;
+    grown = grown && qui_grow_array((void**)&hi->order, &capacity, total, sizeof(uint64_t));
+    capacity = hi->entry_capacity;
+    grown = grown && qui_grow_array((void**)&hi->ids, &capacity, total, sizeof(qui_Id));
+    if (!grown) {
+        hi->cols = 0;
+        hi->rows = 0;
+        return;
+    }
+    hi->entry_capacity = capacity;
+    
+    int offset = 0;
+    for (int c = 0; c < cells; c++) {
+        int count = hi->cell_start[c];
+        hi->cell_start[c] = offset;
+        offset += count;
+    }
+    
+    /* Fill cells, using each start offset as a write cursor */
+    qui_Id cached_window = 0;
+    uint64_t cached_z = 0;
+    for (int i = 0; i < n; i++) {
+        const qui_HitRecord *rec = &hi->records[i];
+        if (rec->window != cached_window) {
+            int index = qui_find_window(ctx, rec->window);
+            cached_window = rec->window;
+            cached_z = (uint64_t)(index + 1);
+        }
+        uint64_t order = (cached_window ? cached_z : 0) << 32 | (uint64_t)i;
+        
+        int cx0, cy0, cx1, cy1;
+        qui_hit_cells(hi, rec, &cx0, &cy0, &cx1, &cy1);
+        for (int cy = cy0; cy <= cy1; cy++) {
+            for (int cx = cx0; cx <= cx1; cx++) {
+                int e = hi->cell_start[cy * cols + cx]++;
+                hi->x0[e] = rec->x0;
+                hi->y0[e] = rec->y0;
+                hi->x1[e] = rec->x1;
+                hi->y1[e] = rec->y1;
+                hi->order[e] = order;
+                hi->ids[e] = rec->id;
+            }
+        }
+    }
+    
+    /* The cursors now hold each cell's end; shift them back to starts */
+    for (int c = cells; c > 0; c--) {
+        hi->cell_start[c] = hi->cell_start[c - 1];
+    }
+    hi->cell_start[0] = 0;
+    hi->entry_count = total;
+}
+
+/** @brief Topmost widget whose hit rectangle contains a point, 0 if none */
+static qui_Id qui_hit_index_query(const qui_HitIndex *hi, float px, float py) {
+    if (hi->cols == 0) return 0;
+    
+    float fx = (px - hi->origin_x) * hi->inv_cell_w;
+    float fy = (py - hi->origin_y) * hi->inv_cell_h;
+    if (fx < 0.0f || fy < 0.0f) return 0;
+    int cx = (int)fx;
+    int cy = (int)fy;
+    /* Points on the far edge belong to the last cell */
+    if (cx == hi->cols && px <= hi->origin_x + (float)hi->cols / hi->inv_cell_w) cx--;
+    if (cy == hi->rows && py <= hi->origin_y + (float)hi->rows / hi->inv_cell_h) cy--;
+    if (cx >= hi->cols || cy >= hi->rows) return 0;
+    
+    int e = hi->cell_start[cy * hi->cols + cx];
+    int end = hi->cell_start[cy * hi->cols + cx + 1];
+    int best = -1;
+    
+#ifdef QUI_SIMD_SSE2
+    /* Four containment tests per step; the few hits are ranked in scalar code */
+    __m128 vx = _mm_set1_ps(px);
+    __m128 vy = _mm_set1_ps(py);
+    for (; e + 4 <= end; e += 4) {
+        __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(hi->x0 + e), vx),
+                                              _mm_cmpge_ps(_mm_loadu_ps(hi->x1 + e), vx)),
+                                   _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(hi->y0 + e), vy),
+                                              _mm_cmpge_ps(_mm_loadu_ps(hi->y1 + e), vy)));
+        int mask = _mm_movemask_ps(inside);
+        for (int k = 0; mask; k++, mask >>= 1) {
+            if ((mask & 1) && (best < 0 || hi->order[e + k] > hi->order[best])) best = e + k;
+        }
+    }
+#endif
+    
+    for (; e < end; e++) {
+        if (px >= hi->x0[e] && px <= hi->x1[e] && py >= hi->y0[e] && py <= hi->y1[e] &&
+            (best < 0 || hi->order[e] > hi->order[best])) {
+            best = e;
+        }
+    }
+    
+    return (best >= 0) ? hi->ids[best] : 0;
+}
+
+/** @brief Free the hit index arrays */
+static void qui_hit_index_release(qui_HitIndex *hi) {
+    QUI_FREE(hi->records);
+    QUI_FREE(hi->cell_start);
+    QUI_FREE(hi->x0);
+    QUI_FREE(hi->y0);
+    QUI_FREE(hi->x1);
+    QUI_FREE(hi->y1);
+    QUI_FREE(hi->order);
+    QUI_FREE(hi->ids);
+    memset(hi, 0, sizeof(*hi));
+}
+
+/** @brief Returned by qui_utf8_decode() for bytes that are not valid UTF-8 */
+#define QUI_UTF8_INVALID 0xFFFFFFFFu
+
+/** @brief Decode one code point; *length receives the bytes consumed (at least 1) */
+static uint32_t qui_utf8_decode(const unsigned char *s, int *length) {
+    static const uint32_t min_value[5] = { 0, 0, 0x80, 0x800, 0x10000 };
+    int n = (s[0] < 0x80) ? 1 : (s[0] >> 5) == 0x6 ? 2 : (s[0] >> 4) == 0xE ? 3 : (s[0] >> 3) == 0x1E ? 4 : 0;
+    *length = 1;
+    if (n == 0) return QUI_UTF8_INVALID;
+    
+    uint32_t cp = (n == 1) ? s[0] : (uint32_t)(s[0] & (0x7F >> n));
+    for (int i = 1; i < n; i++) {
+        if ((s[i] & 0xC0) != 0x80) return QUI_UTF8_INVALID;
+        cp = (cp << 6) | (s[i] & 0x3F);
+    }
+    if (cp < min_value[n] || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) return QUI_UTF8_INVALID;
+    *length = n;
+    return cp;
+}
+
+/** @brief Offset of the character after the one at pos */
+static size_t qui_utf8_next(const char *s, size_t pos, size_t length) {
+    if (pos >= length) return length;
+    pos++;
+    while (pos < length && ((unsigned char)s[pos] & 0xC0) == 0x80) pos++;
+    return pos;
+}
+
+/** @brief Offset of the character before pos */
+static size_t qui_utf8_prev(const char *s, size_t pos) {
+    if (pos == 0) return 0;
+    pos--;
+    while (pos > 0 && ((unsigned char)s[pos] & 0xC0) == 0x80) pos--;
+    return pos;
+}
+
+/** @brief Encode a code point as UTF-8, returns the number of bytes */
+static int qui_utf8_encode(uint32_t cp, char *out) {
+    if (cp < 0x80) {
+        out[0] = (char)cp;
+        return 1;
+    }
+    if (cp < 0x800) {
+        out[0] = (char)(0xC0 | (cp >> 6));
+        out[1] = (char)(0x80 | (cp & 0x3F));
+        return 2;
+    }
+    if (cp < 0x10000) {
+        out[0] = (char)(0xE0 | (cp >> 12));
+        out[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (cp & 0x3F));
+        return 3;
+    }
+    out[0] = (char)(0xF0 | (cp >> 18));
+    out[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (cp & 0x3F));
+    return 4;
+}
+
+/**
+ * @brief Apply queued events to this frame's input state
+ * 
+ * Stops after a button change (or when the text or key buffer is full) so each frame sees
+ * at most one press or release at the position it happened; the rest waits for the
+ * next frame.
+ */
+static void qui_apply_input(qui_Context *ctx) {
+    uint32_t mask = QUI_INPUT_QUEUE_SIZE - 1;
+    ctx->text_input_length = 0;
+    ctx->text_input[0] = '\0';
+    ctx->key_count = 0;
+    ctx->input_time_ns = 0;
+    
+    while (ctx->input_head != ctx->input_tail) {
+        const qui_InputEvent *e = &ctx->input_queue[ctx->input_head & mask];
+        
+        if (e->type == QUI_EVENT_KEY && ctx->key_count >= QUI_MAX_FRAME_KEYS) break;
+        if (e->type == QUI_EVENT_TEXT) {
+            char utf8[4];
+            int n = qui_utf8_encode((uint32_t)e->value, utf8);
+            if (ctx->text_input_length + n >= QUI_TEXT_INPUT_SIZE) break;
+            memcpy(ctx->text_input + ctx->text_input_length, utf8, (size_t)n);
+            ctx->text_input_length += n;
+            ctx->text_input[ctx->text_input_length] = '\0';
+        }
+        
+        switch (e->type) {
+            case QUI_EVENT_MOVE:
+                ctx->mouse_pos.x = e->x;
+                ctx->mouse_pos.y = e->y;
+                break;
+            case QUI_EVENT_BUTTON:
+                ctx->mouse_pos.x = e->x;
+                ctx->mouse_pos.y = e->y;
+                ctx->mouse_down = e->value;
+                if (e->value) ctx->mouse_pressed = 1;
+                else ctx->mouse_released = 1;
+                break;
+            case QUI_EVENT_WHEEL:
+                ctx->mouse_wheel += e->wheel;
+                break;
+            case QUI_EVENT_KEY: {
+                int key = e->value & ~QUI_KEY_SHIFT;
+                if (key == QUI_KEY_BACKSPACE) ctx->key_backspace = 1;
+                if (key == QUI_KEY_ENTER) ctx->key_enter = 1;
+                ctx->keys[ctx->key_count] = e->value;
+                ctx->key_text_offset[ctx->key_count] = ctx->text_input_length;
+                ctx->key_count++;
+                break;
+            }
+            case QUI_EVENT_TEXT:
+                break;
+        }
+        
+        if (ctx->input_time_ns == 0 || e->time_ns < ctx->input_time_ns) {
+            ctx->input_time_ns = e->time_ns;
+        }
+        QUI_STAT_ADD(ctx, input_events, 1);
+        ctx->input_head++;
+        if (e->type == QUI_EVENT_BUTTON) break;
+    }
     
-    ctx->draw_image(ctx, image, x + ox, y + oy, w, h);
+    /* Whatever is left needs another frame */
+    if (ctx->input_head != ctx->input_tail) {
+        ctx->redraw_requested = true;
+    }
 }
 
 /* ================================================================================================
@@ -672,8 +3772,22 @@ qui_Result qui_init(qui_Context *ctx, void *user_data) {
     /* Copy default color scheme */
     memcpy(ctx->colors, QUI_DEFAULT_COLORS, sizeof(QUI_DEFAULT_COLORS));
     
-    /* Initialize ID counter */
+    /* Allocate the frame arena */
+    if (!qui_arena_push_block(&ctx->frame_arena, QUI_FRAME_ARENA_SIZE)) {
+        return QUI_ERROR_OUT_OF_MEMORY;
+    }
+    
+    /* Initialize ID state */
     ctx->last_id = 0;
+    ctx->id_stack_depth = 0;
+    
+    /* Draw the first frames unconditionally */
+    ctx->redraw_requested = true;
+    ctx->redraw_frames = QUI_SETTLE_FRAMES;
+    
+    /* Widget state storage is allocated on first use */
+    ctx->state.free_block = QUI_STATE_NO_BLOCK;
+    ctx->state.max_age = QUI_STATE_MAX_AGE;
     
     /* Initialize font properties */
     ctx->font = NULL;
@@ -686,8 +3800,17 @@ qui_Result qui_init(qui_Context *ctx, void *user_data) {
 qui_Result qui_cleanup(qui_Context *ctx) {
     QUI_VALIDATE_CTX(ctx);
     
-    /* Currently no dynamic resources to clean up */
-    /* This function is provided for future extensibility */
+    /* Release draw list, trace, widget state, ID check and arena storage */
+    qui_disable_draw_list(ctx);
+    qui_enable_damage_tracking(ctx, false);
+    qui_enable_trace(ctx, 0);
+    qui_hit_index_release(&ctx->hit_index);
+    qui_state_release(&ctx->state);
+    QUI_FREE(ctx->id_seen);
+    ctx->id_seen = NULL;
+    ctx->id_seen_capacity = 0;
+    qui_arena_release(&ctx->frame_arena);
+    memset(&ctx->frame_arena, 0, sizeof(ctx->frame_arena));
     
     return QUI_OK;
 }
@@ -700,11 +3823,64 @@ qui_Result qui_begin(qui_Context *ctx, float start_x, float start_y) {
         return QUI_ERROR_INVALID_VALUE;
     }
     
+#ifdef QUI_STATS
+    memset(&ctx->stats, 0, sizeof(ctx->stats));
+    ctx->frame_start_ns = qui_time_ns();
+#endif
+    QUI_TRACE_PUSH(ctx, QUI_TRACE_FRAME, "frame");
+    
     /* Reset layout state */
     ctx->cursor_x = start_x;
     ctx->cursor_y = start_y;
     ctx->last_id = 0;
     ctx->hot_id = 0;
+    ctx->id_stack_depth = 0;
+    ctx->frame_index++;
+    ctx->id_seen_count = 0;
+    
+    /* Input fed from here on belongs to the next frame */
+    ctx->redraw_requested = false;
+    qui_apply_input(ctx);
+    ctx->frame_hash = 0xCBF29CE484222325ull;
+    
+    /* Evict widget state that has not been used for a while */
+    qui_state_collect(ctx);
+    
+    /* Start fresh scratch memory and command list */
+    qui_arena_reset(&ctx->frame_arena);
+    ctx->draw_list.count = 0;
+    ctx->draw_list.font = ctx->atlas_font;
+    ctx->draw_list.dropped = 0;
+    
+    ctx->clip = QUI_CLIP_NONE;
+    ctx->clip_depth = 0;
+    ctx->scroll_depth = 0;
+    ctx->backend_clip_set = false;
+    
+    /* Layout scopes and windows */
+    ctx->layout_offset_x = 0.0f;
+    ctx->layout_offset_y = 0.0f;
+    ctx->layout_start_x = start_x;
+    ctx->content_width = 0.0f;
+    ctx->row.active = false;
+    ctx->layout_serial = 0;
+    ctx->layout_depth = 0;
+    ctx->current_window = 0;
+    ctx->segment_count = 0;
+    ctx->segment_start = 0;
+    ctx->segments_overflow = false;
+    qui_update_windows(ctx);
+    
+    /* Hover is one point query against last frame's widget rectangles */
+    ctx->hover_id = qui_hit_index_query(&ctx->hit_index, (float)ctx->mouse_pos.x, (float)ctx->mouse_pos.y);
+    QUI_STAT_ADD(ctx, hit_queries, 1);
+    ctx->hit_index.count = 0;
+    
+    /* Primitives drawn before the first widget belong to a root record */
+    ctx->damage.count = 0;
+    if (ctx->damage.enabled) {
+        qui_damage_begin_widget(ctx, 0);
+    }
     
     return QUI_OK;
 }
@@ -712,86 +3888,271 @@ qui_Result qui_begin(qui_Context *ctx, float start_x, float start_y) {
 qui_Result qui_end(qui_Context *ctx) {
     QUI_VALIDATE_CTX(ctx);
     
+    /* Close the last run of commands (this also leaves the backend unscissored) */
+    qui_switch_segment(ctx, 0);
+    if (ctx->draw_list_enabled) {
+        qui_sort_draw_list(ctx);
+    }
+    qui_hit_index_build(ctx);
+    
+    /* Keep drawing while the output or interaction state is still changing */
+    bool changed = ctx->frame_hash != ctx->last_frame_hash ||
+                   ctx->hot_id != ctx->last_hot_id ||
+                   ctx->active_id != ctx->last_active_id ||
+                   ctx->keyboard_focus_id != ctx->last_focus_id ||
+                   ctx->mouse_pressed || ctx->mouse_released ||
+                   ctx->key_count > 0 || ctx->text_input_length > 0;
+    if (changed) {
+        ctx->redraw_frames = QUI_SETTLE_FRAMES;
+    } else if (ctx->redraw_frames > 0) {
+        ctx->redraw_frames--;
+    }
+    ctx->last_frame_hash = ctx->frame_hash;
+    if (ctx->damage.enabled) {
+        qui_damage_finish(ctx);
+    }
+    ctx->last_hot_id = ctx->hot_id;
+    ctx->last_active_id = ctx->active_id;
+    ctx->last_focus_id = ctx->keyboard_focus_id;
+    
     /* Clear frame-specific input states */
     ctx->mouse_pressed = 0;
     ctx->mouse_released = 0;
     ctx->key_backspace = 0;
     ctx->key_enter = 0;
+    ctx->mouse_wheel = 0.0f;
+    
+#ifdef QUI_STATS
+    ctx->stats.arena_bytes = ctx->frame_arena.spilled + ctx->frame_arena.used;
+    ctx->stats.draw_list_bytes = sizeof(qui_DrawCmd) * (size_t)ctx->draw_list.count;
+    ctx->stats.hit_bytes = sizeof(qui_HitRecord) * (size_t)ctx->hit_index.count;
+    ctx->stats.frame_ns = qui_time_ns() - ctx->frame_start_ns;
+    if (ctx->input_time_ns != 0) {
+        ctx->stats.input_latency_ns = qui_time_ns() - ctx->input_time_ns;
+    }
+#endif
+    QUI_TRACE_POP(ctx);
     
     return QUI_OK;
 }
 
-const char* qui_get_error_string(qui_Result result) {
-    switch (result) {
-        case QUI_OK: return "Success";
-        case QUI_ERROR_NULL_POINTER: return "Null pointer argument";
-        case QUI_ERROR_INVALID_VALUE: return "Invalid parameter value";
-        case QUI_ERROR_NOT_INITIALIZED: return "Context not initialized";
-        case QUI_ERROR_BUFFER_TOO_SMALL: return "Buffer capacity too small";
-        case QUI_ERROR_INVALID_STATE: return "Invalid operation for current state";
-        default: return "Unknown error";
-    }
+bool qui_needs_redraw(const qui_Context *ctx) {
+    if (!ctx) return false;
+    return ctx->redraw_requested || ctx->redraw_frames > 0;
 }
 
-/* ================================================================================================
- * INPUT HANDLING IMPLEMENTATION
- * ================================================================================================ */
+int qui_frames_until_idle(const qui_Context *ctx) {
+    if (!ctx) return 0;
+    if (ctx->redraw_requested && ctx->redraw_frames < 1) return 1;
+    return ctx->redraw_frames;
+}
 
-qui_Result qui_mouse_down(qui_Context *ctx, int x, int y) {
+qui_Result qui_request_redraw(qui_Context *ctx) {
     QUI_VALIDATE_CTX(ctx);
     
-    ctx->mouse_pos.x = x;
-    ctx->mouse_pos.y = y;
-    ctx->mouse_down = 1;
-    ctx->mouse_pressed = 1;
+    ctx->redraw_requested = true;
     
     return QUI_OK;
 }
 
-qui_Result qui_mouse_up(qui_Context *ctx, int x, int y) {
+qui_Result qui_enable_damage_tracking(qui_Context *ctx, bool enabled) {
     QUI_VALIDATE_CTX(ctx);
     
-    ctx->mouse_pos.x = x;
-    ctx->mouse_pos.y = y;
-    ctx->mouse_down = 0;
-    ctx->mouse_released = 1;
+    if (!enabled) {
+        QUI_FREE(ctx->damage.records);
+        QUI_FREE(ctx->damage.previous);
+        memset(&ctx->damage, 0, sizeof(ctx->damage));
+        return QUI_OK;
+    }
     
+    ctx->damage.enabled = true;
     return QUI_OK;
 }
 
-qui_Result qui_mouse_move(qui_Context *ctx, int x, int y) {
+const qui_Rect* qui_get_damage_rects(const qui_Context *ctx, int *count) {
+    if (!count) return NULL;
+    *count = 0;
+    if (!ctx || !ctx->damage.enabled || ctx->damage.rect_count == 0) return NULL;
+    
+    *count = ctx->damage.rect_count;
+    return ctx->damage.rects;
+}
+
+const char* qui_get_error_string(qui_Result result) {
+    switch (result) {
+        case QUI_OK: return "Success";
+        case QUI_ERROR_NULL_POINTER: return "Null pointer argument";
+        case QUI_ERROR_INVALID_VALUE: return "Invalid parameter value";
+        case QUI_ERROR_NOT_INITIALIZED: return "Context not initialized";
+        case QUI_ERROR_BUFFER_TOO_SMALL: return "Buffer capacity too small";
+        case QUI_ERROR_INVALID_STATE: return "Invalid operation for current state";
+        case QUI_ERROR_OUT_OF_MEMORY: return "Out of memory";
+        default: return "Unknown error";
+    }
+}
+
+/* ================================================================================================
+ * INPUT HANDLING IMPLEMENTATION
+ * ================================================================================================ */
+
+qui_Result qui_push_event(qui_Context *ctx, const qui_InputEvent *event) {
     QUI_VALIDATE_CTX(ctx);
+    QUI_VALIDATE_PTR(event);
+    
+    qui_InputEvent e = *event;
+    if (e.time_ns == 0) e.time_ns = qui_time_ns();
+    if (e.type == QUI_EVENT_MOVE || e.type == QUI_EVENT_BUTTON) {
+        ctx->input_pos.x = e.x;
+        ctx->input_pos.y = e.y;
+    }
+    ctx->redraw_requested = true;
+    
+    /* Merge with a pending move; it keeps its older timestamp for latency */
+    uint32_t mask = QUI_INPUT_QUEUE_SIZE - 1;
+    if (e.type == QUI_EVENT_MOVE && ctx->input_tail != ctx->input_head) {
+        qui_InputEvent *last = &ctx->input_queue[(ctx->input_tail - 1) & mask];
+        if (last->type == QUI_EVENT_MOVE) {
+            last->x = e.x;
+            last->y = e.y;
+            return QUI_OK;
+        }
+    }
     
-    ctx->mouse_pos.x = x;
-    ctx->mouse_pos.y = y;
+    if (ctx->input_tail - ctx->input_head >= QUI_INPUT_QUEUE_SIZE) {
+        ctx->input_dropped++;
+        return QUI_ERROR_BUFFER_TOO_SMALL;
+    }
+    ctx->input_queue[ctx->input_tail++ & mask] = e;
     
     return QUI_OK;
 }
 
-qui_Result qui_feed_mouse_button(qui_Context *ctx, int pressed) {
+/** @brief Queue an event without a payload beyond its type and value */
+static qui_Result qui_push_simple_event(qui_Context *ctx, qui_EventType type, int x, int y, int value) {
+    qui_InputEvent e;
+    memset(&e, 0, sizeof(e));
+    e.type = type;
+    e.x = x;
+    e.y = y;
+    e.value = value;
+    return qui_push_event(ctx, &e);
+}
+
+qui_Result qui_mouse_down(qui_Context *ctx, int x, int y) {
     QUI_VALIDATE_CTX(ctx);
     
-    ctx->mouse_pressed = pressed ? 1 : 0;
+    return qui_push_simple_event(ctx, QUI_EVENT_BUTTON, x, y, 1);
+}
+
+qui_Result qui_mouse_up(qui_Context *ctx, int x, int y) {
+    QUI_VALIDATE_CTX(ctx);
     
-    return QUI_OK;
+    return qui_push_simple_event(ctx, QUI_EVENT_BUTTON, x, y, 0);
 }
 
-qui_Result qui_feed_key_backspace(qui_Context *ctx) {
+qui_Result qui_mouse_move(qui_Context *ctx, int x, int y) {
     QUI_VALIDATE_CTX(ctx);
     
-    ctx->key_backspace = 1;
+    if (ctx->input_pos.x == x && ctx->input_pos.y == y) {
+        return QUI_OK;
+    }
     
-    return QUI_OK;
+    return qui_push_simple_event(ctx, QUI_EVENT_MOVE, x, y, 0);
+}
+
+qui_Result qui_mouse_wheel(qui_Context *ctx, float delta) {
+    QUI_VALIDATE_CTX(ctx);
+    
+    if (!isfinite(delta)) {
+        return QUI_ERROR_INVALID_VALUE;
+    }
+    if (delta == 0.0f) {
+        return QUI_OK;
+    }
+    
+    qui_InputEvent e;
+    memset(&e, 0, sizeof(e));
+    e.type = QUI_EVENT_WHEEL;
+    e.wheel = delta;
+    return qui_push_event(ctx, &e);
+}
+
+qui_Result qui_feed_mouse_button(qui_Context *ctx, int pressed) {
+    QUI_VALIDATE_CTX(ctx);
+    
+    return qui_push_simple_event(ctx, QUI_EVENT_BUTTON, ctx->input_pos.x, ctx->input_pos.y, pressed ? 1 : 0);
+}
+
+qui_Result qui_feed_key_backspace(qui_Context *ctx) {
+    QUI_VALIDATE_CTX(ctx);
+    
+    return qui_push_simple_event(ctx, QUI_EVENT_KEY, 0, 0, QUI_KEY_BACKSPACE);
 }
 
 qui_Result qui_feed_key_enter(qui_Context *ctx) {
     QUI_VALIDATE_CTX(ctx);
     
-    ctx->key_enter = 1;
+    return qui_push_simple_event(ctx, QUI_EVENT_KEY, 0, 0, QUI_KEY_ENTER);
+}
+
+/** @brief Check whether a code point can be typed (no controls, surrogates or out-of-range values) */
+static bool qui_is_text_char(uint32_t codepoint) {
+    return codepoint >= 0x20 && codepoint != 0x7F && codepoint <= 0x10FFFF &&
+           (codepoint < 0xD800 || codepoint > 0xDFFF);
+}
+
+qui_Result qui_feed_char(qui_Context *ctx, uint32_t codepoint) {
+    QUI_VALIDATE_CTX(ctx);
+    
+    if (!qui_is_text_char(codepoint)) {
+        return QUI_ERROR_INVALID_VALUE;
+    }
+    
+    return qui_push_simple_event(ctx, QUI_EVENT_TEXT, 0, 0, (int)codepoint);
+}
+
+qui_Result qui_feed_text(qui_Context *ctx, const char *utf8) {
+    QUI_VALIDATE_CTX(ctx);
+    QUI_VALIDATE_PTR(utf8);
+    
+    /* Count the characters first so the text is never queued partially */
+    uint32_t count = 0;
+    const unsigned char *p = (const unsigned char*)utf8;
+    while (*p) {
+        int n;
+        uint32_t cp = qui_utf8_decode(p, &n);
+        p += n;
+        if (qui_is_text_char(cp)) count++;
+    }
+    if (count > QUI_INPUT_QUEUE_SIZE - (ctx->input_tail - ctx->input_head)) {
+        ctx->input_dropped += count;
+        return QUI_ERROR_BUFFER_TOO_SMALL;
+    }
+    
+    p = (const unsigned char*)utf8;
+    while (*p) {
+        int n;
+        uint32_t cp = qui_utf8_decode(p, &n);
+        p += n;
+        if (qui_is_text_char(cp)) {
+            qui_push_simple_event(ctx, QUI_EVENT_TEXT, 0, 0, (int)cp);
+        }
+    }
     
     return QUI_OK;
 }
 
+qui_Result qui_feed_key(qui_Context *ctx, int key) {
+    QUI_VALIDATE_CTX(ctx);
+    
+    int base = key & ~QUI_KEY_SHIFT;
+    if (base < QUI_KEY_BACKSPACE || base > QUI_KEY_PAGE_DOWN) {
+        return QUI_ERROR_INVALID_VALUE;
+    }
+    
+    return qui_push_simple_event(ctx, QUI_EVENT_KEY, 0, 0, key);
+}
+
 /* ================================================================================================
  * UTILITY FUNCTIONS IMPLEMENTATION
  * ================================================================================================ */
@@ -806,6 +4167,16 @@ qui_Rect qui_rect(int width, int height, int pos_x, int pos_y) {
     return r;
 }
 
+qui_Image qui_image(void *data, int width, int height, int channels) {
+    qui_Image image;
+    memset(&image, 0, sizeof(image));
+    image.data = data;
+    image.width = width;
+    image.height = height;
+    image.channels = channels;
+    return image;
+}
+
 qui_Color qui_color(int r, int g, int b, int a) {
     /* Clamp values to valid range */
     if (r < 0) r = 0; else if (r > 255) r = 255;
@@ -817,6 +4188,18 @@ qui_Color qui_color(int r, int g, int b, int a) {
     return color;
 }
 
+qui_Color32 qui_pack_color(qui_Color color) {
+    return  (uint32_t)(color.r & 0xFF) |
+           ((uint32_t)(color.g & 0xFF) << 8) |
+           ((uint32_t)(color.b & 0xFF) << 16) |
+           ((uint32_t)(color.a & 0xFF) << 24);
+}
+
+qui_Color qui_unpack_color(qui_Color32 color) {
+    qui_Color c = {(int)(color & 0xFF), (int)((color >> 8) & 0xFF), (int)((color >> 16) & 0xFF), (int)(color >> 24)};
+    return c;
+}
+
 qui_Result qui_set_color(qui_Context *ctx, qui_ColorType type, qui_Color color) {
     QUI_VALIDATE_CTX(ctx);
     
@@ -824,7 +4207,8 @@ qui_Result qui_set_color(qui_Context *ctx, qui_ColorType type, qui_Color color)
         return QUI_ERROR_INVALID_VALUE;
     }
     
-    ctx->colors[type] = color;
+    ctx->colors[type] = qui_pack_color(color);
+    ctx->redraw_requested = true;
     return QUI_OK;
 }
 
@@ -836,7 +4220,7 @@ qui_Result qui_get_color(qui_Context *ctx, qui_ColorType type, qui_Color *color)
         return QUI_ERROR_INVALID_VALUE;
     }
     
-    *color = ctx->colors[type];
+    *color = qui_unpack_color(ctx->colors[type]);
     return QUI_OK;
 }
 
@@ -851,430 +4235,1163 @@ qui_Result qui_set_font(qui_Context *ctx, void *font, float font_size, float fon
     ctx->font = font;
     ctx->font_size = font_size;
     ctx->font_spacing = font_spacing;
+    ctx->advance_table = NULL;
+    ctx->kerning = NULL;
+    ctx->redraw_requested = true;
+    qui_invalidate_text_cache(ctx);
+    
+    return QUI_OK;
+}
+
+qui_Result qui_set_font_advances(qui_Context *ctx, const float *advances,
+                                 float (*kerning)(qui_Context *ctx, unsigned char left, unsigned char right)) {
+    QUI_VALIDATE_CTX(ctx);
+    
+    ctx->advance_table = advances;
+    ctx->kerning = advances ? kerning : NULL;
+    ctx->redraw_requested = true;
+    qui_invalidate_text_cache(ctx);
+    
+    return QUI_OK;
+}
+
+qui_Result qui_invalidate_text_cache(qui_Context *ctx) {
+    QUI_VALIDATE_CTX(ctx);
+    
+    memset(ctx->text_cache.entries, 0, sizeof(ctx->text_cache.entries));
     
     return QUI_OK;
 }
 
 /* ================================================================================================
- * UI ELEMENTS IMPLEMENTATION
+ * WIDGET IDS IMPLEMENTATION
  * ================================================================================================ */
 
-int qui_button(qui_Context *ctx, const char *label) {
-    if (!ctx || !label) return -1;
+qui_Id qui_get_id(qui_Context *ctx, const char *str) {
+    if (!ctx || !str) return 0;
+    return qui_hash_id(ctx, str, strlen(str));
+}
+
+qui_Id qui_get_id_n(qui_Context *ctx, const char *str, size_t length) {
+    if (!ctx || !str) return 0;
+    return qui_hash_id(ctx, str, length);
+}
+
+qui_Result qui_push_id(qui_Context *ctx, const char *str) {
+    QUI_VALIDATE_CTX(ctx);
+    QUI_VALIDATE_PTR(str);
+    return qui_push_id_n(ctx, str, strlen(str));
+}
+
+qui_Result qui_push_id_n(qui_Context *ctx, const char *str, size_t length) {
+    QUI_VALIDATE_CTX(ctx);
+    QUI_VALIDATE_PTR(str);
     
-    qui_Id id = qui_gen_id(ctx);
-    float text_width = qui_get_text_width(ctx, label);
-    float text_height = qui_get_text_height(ctx, label);
-    float padding = 10.0f;
+    if (ctx->id_stack_depth >= QUI_ID_STACK_SIZE) {
+        return QUI_ERROR_INVALID_STATE;
+    }
     
-    float w = text_width + (padding * 2);
-    float h = text_height + 8.0f;
-    float x = ctx->cursor_x;
-    float y = ctx->cursor_y;
+    ctx->id_stack[ctx->id_stack_depth] = qui_hash_id(ctx, str, length);
+    ctx->id_stack_depth++;
+    return QUI_OK;
+}
+
+qui_Result qui_push_id_int(qui_Context *ctx, int value) {
+    QUI_VALIDATE_CTX(ctx);
     
-    /* Hit testing */
-    if (qui_hit_test(ctx, x, y, w, h)) {
-        ctx->hot_id = id;
-        if (ctx->mouse_pressed) {
-            ctx->active_id = id;
-        }
+    if (ctx->id_stack_depth >= QUI_ID_STACK_SIZE) {
+        return QUI_ERROR_INVALID_STATE;
     }
     
-    /* Determine color based on state */
-    qui_Color color = ctx->colors[QUI_COLOR_FOREGROUND];
-    if (ctx->active_id == id) {
-        color = ctx->colors[QUI_COLOR_ACTIVE];
-    } else if (ctx->hot_id == id) {
-        color = ctx->colors[QUI_COLOR_HOT];
+    ctx->id_stack[ctx->id_stack_depth] = qui_hash_id(ctx, &value, sizeof(value));
+    ctx->id_stack_depth++;
+    return QUI_OK;
+}
+
+qui_Result qui_pop_id(qui_Context *ctx) {
+    QUI_VALIDATE_CTX(ctx);
+    
+    if (ctx->id_stack_depth <= 0) {
+        return QUI_ERROR_INVALID_STATE;
     }
     
-    /* Draw button background */
-    qui_Rect rect = qui_rect((int)w, (int)h, (int)x, (int)y);
-    qui_draw_rect_safe(ctx, &rect, color);
+    ctx->id_stack_depth--;
+    return QUI_OK;
+}
+
+/* ================================================================================================
+ * CLIPPING IMPLEMENTATION
+ * ================================================================================================ */
+
+qui_Result qui_push_clip(qui_Context *ctx, qui_Rect rect) {
+    QUI_VALIDATE_CTX(ctx);
     
-    /* Draw button text */
-    qui_draw_text_safe(ctx, label, x + padding, y + 4.0f);
+    if (rect.width < 0 || rect.height < 0) {
+        return QUI_ERROR_INVALID_VALUE;
+    }
     
-    /* Check for click */
-    int clicked = 0;
-    if (ctx->mouse_released && ctx->active_id == id) {
-        if (qui_hit_test(ctx, x, y, w, h)) {
-            clicked = 1;
-        }
-        ctx->active_id = 0;
+    float x = rect.pos_x + ctx->layout_offset_x;
+    float y = rect.pos_y + ctx->layout_offset_y;
+    qui_ClipRect clip = {x, y, x + (float)rect.width, y + (float)rect.height};
+    if (!qui_push_clip_absolute(ctx, &clip)) {
+        return QUI_ERROR_INVALID_STATE;
     }
+    return QUI_OK;
+}
+
+qui_Result qui_pop_clip(qui_Context *ctx) {
+    QUI_VALIDATE_CTX(ctx);
     
-    /* Update layout cursor */
-    ctx->cursor_y += h + ctx->spacing_y;
-    ctx->cursor_x = ctx->spacing_x;
+    if (ctx->clip_depth <= 0) {
+        return QUI_ERROR_INVALID_STATE;
+    }
     
-    return clicked;
+    ctx->clip = ctx->clip_stack[--ctx->clip_depth];
+    return QUI_OK;
 }
 
-int qui_checkbox(qui_Context *ctx, const char *label, int *value) {
-    if (!ctx || !label || !value) return -1;
+/* ================================================================================================
+ * WIDGET STATE IMPLEMENTATION
+ * ================================================================================================ */
+
+void* qui_get_state(qui_Context *ctx, qui_Id id, size_t size) {
+    if (!ctx || id == 0 || size > QUI_STATE_BLOCK_SIZE) return NULL;
     
-    qui_Id id = qui_gen_id(ctx);
-    float box_size = 18.0f;
-    float text_width = qui_get_text_width(ctx, label);
-    float text_height = qui_get_text_height(ctx, label);
-    float spacing = 6.0f;
+    qui_StateStore *store = &ctx->state;
     
-    float total_width = box_size + spacing + text_width;
-    float h = fmaxf(box_size, text_height);
-    float x = ctx->cursor_x;
-    float y = ctx->cursor_y;
+    /* Keep the load factor below 3/4 */
+    if ((store->live + 1) * 4 > store->slot_capacity * 3) {
+        uint32_t capacity = store->slot_capacity ? store->slot_capacity * 2 : 256;
+        if (!qui_state_rehash(store, capacity)) return NULL;
+    }
     
-    /* Hit testing */
-    if (qui_hit_test(ctx, x, y, total_width, h)) {
-        ctx->hot_id = id;
-        if (ctx->mouse_pressed) {
-            ctx->active_id = id;
+    uint32_t mask = store->slot_capacity - 1;
+    uint32_t slot = qui_state_home(store, id);
+    while (store->slots[slot].id != 0) {
+        if (store->slots[slot].id == id) {
+            store->slots[slot].last_frame = ctx->frame_index;
+            return qui_state_block(store, store->slots[slot].block);
         }
+        slot = (slot + 1) & mask;
     }
     
-    /* Determine color based on state */
-    qui_Color color = ctx->colors[QUI_COLOR_FOREGROUND];
-    if (ctx->active_id == id) {
-        color = ctx->colors[QUI_COLOR_ACTIVE];
-    } else if (ctx->hot_id == id) {
-        color = ctx->colors[QUI_COLOR_HOT];
-    }
+    uint32_t block = qui_state_alloc_block(store);
+    if (block == QUI_STATE_NO_BLOCK) return NULL;
     
-    /* Draw checkbox box */
-    qui_Rect box_rect = qui_rect((int)box_size, (int)box_size, (int)x, (int)y);
-    qui_draw_rect_safe(ctx, &box_rect, color);
+    store->slots[slot].id = id;
+    store->slots[slot].last_frame = ctx->frame_index;
+    store->slots[slot].block = block;
+    store->live++;
     
-    /* Draw check mark if checked */
-    if (*value) {
-        qui_draw_text_safe(ctx, "X", x + 4.0f, y + 1.0f);
-    }
+    void *data = qui_state_block(store, block);
+    memset(data, 0, QUI_STATE_BLOCK_SIZE);
+    return data;
+}
+
+qui_Result qui_set_state_max_age(qui_Context *ctx, uint32_t frames) {
+    QUI_VALIDATE_CTX(ctx);
     
-    /* Draw label */
-    qui_draw_text_safe(ctx, label, x + box_size + spacing, y + 1.0f);
+    if (frames == 0) {
+        return QUI_ERROR_INVALID_VALUE;
+    }
     
-    /* Check for click */
-    int changed = 0;
-    if (ctx->mouse_released && ctx->active_id == id) {
-        if (qui_hit_test(ctx, x, y, total_width, h)) {
-            *value = !(*value);
-            changed = 1;
+    ctx->state.max_age = frames;
+    return QUI_OK;
+}
+
+/* ================================================================================================
+ * FRAME ARENA IMPLEMENTATION
+ * ================================================================================================ */
+
+/** @brief Record the bytes used so far this frame */
+static void qui_arena_update_high_water(qui_Arena *arena) {
+    size_t total = arena->spilled + arena->used;
+    if (total > arena->high_water) {
+        arena->high_water = total;
+    }
+}
+
+void* qui_frame_alloc(qui_Context *ctx, size_t size) {
+    if (!ctx) return NULL;
+    
+    qui_Arena *arena = &ctx->frame_arena;
+    size_t offset = (arena->used + 15u) & ~(size_t)15u;
+    if (!arena->base || size > arena->capacity || offset > arena->capacity - size) {
+        if (!qui_arena_push_block(arena, size)) {
+            arena->failures++;
+            return NULL;
         }
-        ctx->active_id = 0;
+        offset = 0;
     }
     
-    /* Update layout cursor */
-    ctx->cursor_y += h + ctx->spacing_y;
-    ctx->cursor_x = ctx->spacing_x;
+    arena->used = offset + size;
+    qui_arena_update_high_water(arena);
+    return arena->base + offset;
+}
+
+char* qui_frame_strndup(qui_Context *ctx, const char *str, size_t len) {
+    if (!ctx || !str) return NULL;
+    
+    /* Strings need no alignment, so pack them tightly */
+    qui_Arena *arena = &ctx->frame_arena;
+    if (!arena->base || len >= arena->capacity - arena->used) {
+        if (len == SIZE_MAX || !qui_arena_push_block(arena, len + 1)) {
+            arena->failures++;
+            return NULL;
+        }
+    }
     
-    return changed;
+    char *copy = (char*)arena->base + arena->used;
+    memcpy(copy, str, len);
+    copy[len] = '\0';
+    arena->used += len + 1;
+    qui_arena_update_high_water(arena);
+    return copy;
 }
 
-int qui_slider(qui_Context *ctx, const char *label, float *value, float min_val, float max_val, float width) {
-    if (!ctx || !label || !value) return -1;
+char* qui_frame_strdup(qui_Context *ctx, const char *str) {
+    if (!ctx || !str) return NULL;
+    return qui_frame_strndup(ctx, str, strlen(str));
+}
+
+const char* qui_frame_printf(qui_Context *ctx, const char *fmt, ...) {
+    if (!ctx || !fmt) return NULL;
     
-    if (min_val >= max_val || !isfinite(min_val) || !isfinite(max_val) || 
-        !isfinite(*value) || width < 0.0f) {
-        return -1;
+    qui_Arena *arena = &ctx->frame_arena;
+    if (!arena->base) {
+        arena->failures++;
+        return NULL;
     }
     
-    qui_Id id = qui_gen_id(ctx);
-    float label_width = qui_get_text_width(ctx, label);
-    float text_height = qui_get_text_height(ctx, label);
-    float slider_width = (width > 0.0f) ? width : 160.0f;
-    float slider_height = 12.0f;
-    float knob_width = 10.0f;
-    float spacing = 12.0f;
-    float value_display_width = 60.0f;
+    /* Format straight into the free tail of the arena */
+    char *out = (char*)arena->base + arena->used;
+    size_t available = arena->capacity - arena->used;
+    va_list args;
+    va_start(args, fmt);
+    int len = vsnprintf(out, available, fmt, args);
+    va_end(args);
+    if (len < 0) {
+        arena->failures++;
+        return NULL;
+    }
     
-    float x = ctx->cursor_x;
-    float y = ctx->cursor_y;
-    float slider_x = x + label_width + spacing;
-    float h = text_height + 8.0f;
+    /* Did not fit: format again into a new block */
+    if ((size_t)len >= available) {
+        if (!qui_arena_push_block(arena, (size_t)len + 1)) {
+            arena->failures++;
+            return NULL;
+        }
+        out = (char*)arena->base;
+        va_start(args, fmt);
+        vsnprintf(out, arena->capacity, fmt, args);
+        va_end(args);
+    }
     
-    /* Clamp value to valid range */
-    if (*value < min_val) *value = min_val;
-    if (*value > max_val) *value = max_val;
+    arena->used += (size_t)len + 1;
+    qui_arena_update_high_water(arena);
+    return out;
+}
+
+qui_Result qui_set_frame_arena_size(qui_Context *ctx, size_t size) {
+    QUI_VALIDATE_CTX(ctx);
     
-    /* Hit testing on slider area */
-    if (qui_hit_test(ctx, slider_x, y, slider_width, slider_height)) {
-        ctx->hot_id = id;
-        if (ctx->mouse_pressed) {
-            ctx->active_id = id;
-        }
+    if (size == 0) {
+        return QUI_ERROR_INVALID_VALUE;
     }
     
-    /* Determine color based on state */
-    qui_Color color = ctx->colors[QUI_COLOR_FOREGROUND];
-    if (ctx->active_id == id) {
-        color = ctx->colors[QUI_COLOR_ACTIVE];
-    } else if (ctx->hot_id == id) {
-        color = ctx->colors[QUI_COLOR_HOT];
+    qui_Arena resized = ctx->frame_arena;
+    resized.block = NULL;
+    resized.capacity = 0;
+    if (!qui_arena_push_block(&resized, size)) {
+        return QUI_ERROR_OUT_OF_MEMORY;
     }
     
-    /* Draw label */
-    qui_draw_text_safe(ctx, label, x, y);
+    qui_arena_release(&ctx->frame_arena);
+    ctx->frame_arena = resized;
+    ctx->frame_arena.used = 0;
+    ctx->frame_arena.spilled = 0;
     
-    /* Draw slider background */
-    qui_Rect slider_bg = qui_rect((int)slider_width, (int)slider_height, (int)slider_x, (int)(y + 2));
-    qui_draw_rect_safe(ctx, &slider_bg, color);
+    return QUI_OK;
+}
+
+/* ================================================================================================
+ * STATISTICS IMPLEMENTATION
+ * ================================================================================================ */
+
+const qui_Stats* qui_get_stats(const qui_Context *ctx) {
+    if (!ctx) return NULL;
+    return &ctx->stats;
+}
+
+uint64_t qui_time_ns(void) {
+#if defined(QUI_TIME_NS)
+    return (uint64_t)(QUI_TIME_NS());
+#elif !defined(QUI_STATS) && !defined(QUI_TRACE)
+    /* Nothing is timed, so no clock is read */
+    return 0;
+#elif defined(CLOCK_MONOTONIC)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#elif defined(TIME_UTC)
+    /* C11 (and MSVC) wall clock: right for intervals unless the system time is changed meanwhile */
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#else
+#error "quickui: QUI_STATS/QUI_TRACE need a clock; define _POSIX_C_SOURCE 199309L before any include, build as C11, or define QUI_TIME_NS()"
+#endif
+}
+
+/* ================================================================================================
+ * TRACING IMPLEMENTATION
+ * ================================================================================================ */
+
+qui_Result qui_enable_trace(qui_Context *ctx, int capacity) {
+    QUI_VALIDATE_CTX(ctx);
     
-    /* Calculate knob position */
-    float t = (*value - min_val) / (max_val - min_val);
-    if (t < 0.0f) t = 0.0f;
-    if (t > 1.0f) t = 1.0f;
-    float knob_x = slider_x + t * (slider_width - knob_width);
+    if (capacity < 0) return QUI_ERROR_INVALID_VALUE;
     
-    /* Handle dragging */
-    if (ctx->active_id == id && ctx->mouse_down) {
-        float local_x = (float)ctx->mouse_pos.x - (slider_x + ctx->layout_offset_x);
-        float new_t = local_x / (slider_width - knob_width);
-        if (new_t < 0.0f) new_t = 0.0f;
-        if (new_t > 1.0f) new_t = 1.0f;
-        *value = min_val + new_t * (max_val - min_val);
+    QUI_FREE(ctx->trace.events);
+    memset(&ctx->trace, 0, sizeof(ctx->trace));
+    if (capacity == 0) return QUI_OK;
+    
+#ifdef QUI_TRACE
+    uint32_t rounded = 1;
+    while (rounded < (uint32_t)capacity) rounded <<= 1;
+    ctx->trace.events = (qui_TraceEvent*)QUI_MALLOC(sizeof(qui_TraceEvent) * rounded);
+    if (!ctx->trace.events) return QUI_ERROR_OUT_OF_MEMORY;
+    ctx->trace.capacity = rounded;
+    return QUI_OK;
+#else
+    return QUI_ERROR_INVALID_STATE;
+#endif
+}
+
+qui_Result qui_trace_begin(qui_Context *ctx, const char *name) {
+    QUI_VALIDATE_CTX(ctx);
+    QUI_VALIDATE_PTR(name);
+    
+    QUI_TRACE_PUSH(ctx, QUI_TRACE_USER, name);
+    
+    return QUI_OK;
+}
+
+qui_Result qui_trace_end(qui_Context *ctx) {
+    QUI_VALIDATE_CTX(ctx);
+    
+    QUI_TRACE_POP(ctx);
+    
+    return QUI_OK;
+}
+
+/** @brief Write a string as a JSON string literal */
+static void qui_write_json_string(FILE *file, const char *str) {
+    fputc('"', file);
+    for (const unsigned char *p = (const unsigned char*)str; *p; p++) {
+        if (*p == '"' || *p == '\\') {
+            fputc('\\', file);
+            fputc(*p, file);
+        } else if (*p < 0x20) {
+            fprintf(file, "\\u%04x", *p);
+        } else {
+            fputc(*p, file);
+        }
+    }
+    fputc('"', file);
+}
+
+qui_Result qui_trace_write_json(qui_Context *ctx, FILE *file) {
+    QUI_VALIDATE_CTX(ctx);
+    QUI_VALIDATE_PTR(file);
+    
+    static const char *category_names[] = { "frame", "window", "user", "backend" };
+    qui_Trace *t = &ctx->trace;
+    
+    /* Events older than one ring's worth were overwritten */
+    uint64_t first = t->flushed;
+    if (t->written - first > t->capacity) first = t->written - t->capacity;
+    
+    fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", file);
+    for (uint64_t i = first; i < t->written; i++) {
+        const qui_TraceEvent *e = &t->events[i & (t->capacity - 1)];
+        fputs((i == first) ? "\n{\"name\":" : ",\n{\"name\":", file);
+        qui_write_json_string(file, e->name);
+        fprintf(file, ",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":1}",
+                category_names[e->category], (double)e->start_ns / 1000.0, (double)e->duration_ns / 1000.0);
     }
+    fputs("\n]}\n", file);
+    t->flushed = t->written;
     
-    if (ctx->mouse_released && ctx->active_id == id) {
-        ctx->active_id = 0;
+    return ferror(file) ? QUI_ERROR_INVALID_STATE : QUI_OK;
+}
+
+/* ================================================================================================
+ * DRAW LIST IMPLEMENTATION
+ * ================================================================================================ */
+
+qui_Result qui_enable_draw_list(qui_Context *ctx, int max_commands) {
+    QUI_VALIDATE_CTX(ctx);
+    
+    if (max_commands <= 0) {
+        return QUI_ERROR_INVALID_VALUE;
     }
     
-    /* Draw knob */
-    qui_Rect knob_rect = qui_rect((int)knob_width, (int)(slider_height + 4), (int)knob_x, (int)y);
-    qui_draw_rect_safe(ctx, &knob_rect, ctx->colors[QUI_COLOR_ACTIVE]);
+    qui_disable_draw_list(ctx);
     
-    /* Draw value display */
-    char value_buffer[32];
-    snprintf(value_buffer, sizeof(value_buffer), "%.2f", *value);
-    qui_draw_text_safe(ctx, value_buffer, slider_x + slider_width + 8.0f, y);
+    qui_DrawCmd *commands = (qui_DrawCmd*)QUI_MALLOC(sizeof(qui_DrawCmd) * (size_t)max_commands);
+    if (!commands) {
+        return QUI_ERROR_OUT_OF_MEMORY;
+    }
     
-    /* Update layout cursor */
-    ctx->cursor_y += h + ctx->spacing_y;
-    ctx->cursor_x = ctx->spacing_x;
+    ctx->draw_list.commands = commands;
+    ctx->draw_list.capacity = max_commands;
+    ctx->draw_list_enabled = true;
     
-    return 1;
+    return QUI_OK;
 }
 
-int qui_textbox(qui_Context *ctx, char *buffer, size_t capacity, float width) {
-    if (!ctx || !buffer || capacity == 0) return -1;
-    
-    qui_Id id = qui_gen_id(ctx);
-    float text_height = qui_get_text_height(ctx, "A");
-    float box_width = (width > 0.0f) ? width : 240.0f;
-    float h = text_height + 8.0f;
-    float padding = 6.0f;
+qui_Result qui_disable_draw_list(qui_Context *ctx) {
+    QUI_VALIDATE_CTX(ctx);
     
-    float x = ctx->cursor_x;
-    float y = ctx->cursor_y;
+    QUI_FREE(ctx->draw_list.commands);
+    memset(&ctx->draw_list, 0, sizeof(ctx->draw_list));
+    ctx->draw_list_enabled = false;
     
-    /* Hit testing */
-    if (qui_hit_test(ctx, x, y, box_width, h)) {
-        ctx->hot_id = id;
-        if (ctx->mouse_pressed) {
-            ctx->keyboard_focus_id = id;
+    return QUI_OK;
+}
+
+const qui_DrawList* qui_get_draw_list(const qui_Context *ctx) {
+    if (!ctx || !ctx->draw_list_enabled) return NULL;
+    return &ctx->draw_list;
+}
+
+qui_Result qui_render_draw_list(qui_Context *ctx, const qui_DrawList *list) {
+    QUI_VALIDATE_CTX(ctx);
+    QUI_VALIDATE_PTR(list);
+    
+    const qui_DrawCmd *cmd = list->commands;
+    const qui_DrawCmd *end = list->commands + list->count;
+    
+    /* Replay is traced as one scope; per-command events would dwarf the callbacks */
+    QUI_TRACE_PUSH(ctx, QUI_TRACE_BACKEND, "render_draw_list");
+    for (; cmd != end; ++cmd) {
+        switch (cmd->type) {
+            case QUI_COMMAND_RECT:
+                if (ctx->draw_rect) ctx->draw_rect(ctx, cmd->x, cmd->y, cmd->w, cmd->h, qui_unpack_color(cmd->color));
+                break;
+            case QUI_COMMAND_TEXT:
+                if (ctx->draw_text) ctx->draw_text(ctx, cmd->text, cmd->x, cmd->y);
+                break;
+            case QUI_COMMAND_IMAGE:
+                if (ctx->draw_image) ctx->draw_image(ctx, cmd->image, cmd->x, cmd->y, cmd->w, cmd->h);
+                break;
+            case QUI_COMMAND_CLIP:
+                if (ctx->set_clip) {
+                    qui_Rect clip = qui_rect((int)cmd->w, (int)cmd->h, (int)cmd->x, (int)cmd->y);
+                    ctx->set_clip(ctx, (cmd->w < 0.0f) ? NULL : &clip);
+                }
+                break;
         }
-    } else if (ctx->mouse_pressed && ctx->keyboard_focus_id == id) {
-        /* Clicked outside while focused - lose focus */
-        ctx->keyboard_focus_id = 0;
     }
+    QUI_TRACE_POP(ctx);
     
-    /* Determine color based on state */
-    qui_Color color = ctx->colors[QUI_COLOR_FOREGROUND];
-    if (ctx->keyboard_focus_id == id) {
-        color = ctx->colors[QUI_COLOR_ACTIVE];
-    } else if (ctx->hot_id == id) {
-        color = ctx->colors[QUI_COLOR_HOT];
+    return QUI_OK;
+}
+
+/* ================================================================================================
+ * VERTEX OUTPUT IMPLEMENTATION
+ * ================================================================================================ */
+
+qui_Result qui_vertex_buffer_init(qui_VertexBuffer *vb, int max_quads, int index_size) {
+    QUI_VALIDATE_PTR(vb);
+    
+    if (max_quads <= 0 || (index_size != 2 && index_size != 4)) {
+        return QUI_ERROR_INVALID_VALUE;
     }
     
-    /* Draw textbox background */
-    qui_Rect rect = qui_rect((int)box_width, (int)h, (int)x, (int)y);
-    qui_draw_rect_safe(ctx, &rect, color);
+    memset(vb, 0, sizeof(*vb));
+    vb->vertices = (qui_Vertex*)QUI_MALLOC(sizeof(qui_Vertex) * 4 * (size_t)max_quads);
+    vb->indices = QUI_MALLOC((size_t)index_size * 6 * (size_t)max_quads);
+    vb->batches = (qui_DrawBatch*)QUI_MALLOC(sizeof(qui_DrawBatch) * (size_t)max_quads);
+    if (!vb->vertices || !vb->indices || !vb->batches) {
+        qui_vertex_buffer_free(vb);
+        return QUI_ERROR_OUT_OF_MEMORY;
+    }
     
-    /* Draw text content */
-    qui_draw_text_safe(ctx, buffer, x + padding, y + 4.0f);
+    vb->vertex_capacity = 4 * max_quads;
+    vb->index_capacity = 6 * max_quads;
+    vb->batch_capacity = max_quads;
+    vb->index_size = index_size;
     
-    /* Draw cursor if focused */
-    if (ctx->keyboard_focus_id == id) {
-        float text_width = qui_get_text_width(ctx, buffer);
-        qui_draw_text_safe(ctx, "|", x + padding + text_width, y + 2.0f);
-    }
+    return QUI_OK;
+}
+
+qui_Result qui_vertex_buffer_free(qui_VertexBuffer *vb) {
+    QUI_VALIDATE_PTR(vb);
     
-    /* Handle keyboard input */
-    if (ctx->keyboard_focus_id == id) {
-        if (ctx->key_backspace) {
-            size_t len = strlen(buffer);
-            if (len > 0) {
-                buffer[len - 1] = '\0';
-            }
-        }
-    }
+    QUI_FREE(vb->vertices);
+    QUI_FREE(vb->indices);
+    QUI_FREE(vb->batches);
+    memset(vb, 0, sizeof(*vb));
     
-    /* Update layout cursor */
-    ctx->cursor_y += h + ctx->spacing_y;
-    ctx->cursor_x = ctx->spacing_x;
+    return QUI_OK;
+}
+
+/** @brief Start a new batch at the current end of the buffers */
+static qui_DrawBatch* qui_open_batch(qui_VertexBuffer *vb, qui_Image *texture, const qui_DrawCmd *command) {
+    if (vb->batch_count >= vb->batch_capacity) return NULL;
+    
+    qui_DrawBatch *batch = &vb->batches[vb->batch_count++];
+    batch->texture = texture;
+    batch->command = command;
+    batch->vertex_offset = (uint32_t)vb->vertex_count;
+    batch->index_offset = (uint32_t)vb->index_count;
+    batch->index_count = 0;
+    return batch;
+}
+
+/** @brief Append one quad to the open batch */
+static void qui_emit_quad(qui_VertexBuffer *vb, qui_DrawBatch *batch,
+                          float x0, float y0, float x1, float y1,
+                          float u0, float v0, float u1, float v1, qui_Color32 color) {
+    qui_Vertex *v = &vb->vertices[vb->vertex_count];
+    v[0].x = x0; v[0].y = y0; v[0].u = u0; v[0].v = v0; v[0].color = color;
+    v[1].x = x1; v[1].y = y0; v[1].u = u1; v[1].v = v0; v[1].color = color;
+    v[2].x = x1; v[2].y = y1; v[2].u = u1; v[2].v = v1; v[2].color = color;
+    v[3].x = x0; v[3].y = y1; v[3].u = u0; v[3].v = v1; v[3].color = color;
+    
+    uint32_t base = (uint32_t)vb->vertex_count - batch->vertex_offset;
+    if (vb->index_size == 2) {
+        uint16_t *idx = (uint16_t*)vb->indices + vb->index_count;
+        idx[0] = (uint16_t)base;       idx[1] = (uint16_t)(base + 1); idx[2] = (uint16_t)(base + 2);
+        idx[3] = (uint16_t)base;       idx[4] = (uint16_t)(base + 2); idx[5] = (uint16_t)(base + 3);
+    } else {
+        uint32_t *idx = (uint32_t*)vb->indices + vb->index_count;
+        idx[0] = base; idx[1] = base + 1; idx[2] = base + 2;
+        idx[3] = base; idx[4] = base + 2; idx[5] = base + 3;
+    }
     
-    return (ctx->keyboard_focus_id == id) ? 1 : 0;
+    vb->vertex_count += 4;
+    vb->index_count += 6;
+    batch->index_count += 6;
 }
 
-int qui_image_button(qui_Context *ctx, qui_Image *image, float button_width, float button_height, float img_width, float img_height) {
-    if (!ctx || !image) return -1;
+qui_Result qui_build_vertex_buffer(const qui_DrawList *list, qui_VertexBuffer *vb) {
+    QUI_VALIDATE_PTR(list);
+    QUI_VALIDATE_PTR(vb);
     
-    if (image->width <= 0 || image->height <= 0 || !image->data) {
-        return -1;
+    if (!vb->vertices || !vb->indices || !vb->batches) {
+        return QUI_ERROR_NOT_INITIALIZED;
     }
     
-    qui_Id id = qui_gen_id(ctx);
+    vb->vertex_count = 0;
+    vb->index_count = 0;
+    vb->batch_count = 0;
+    vb->dropped = 0;
     
-    /* Calculate dimensions */
-    float padding = 8.0f;
-    float w = (button_width > 0.0f) ? button_width : (float)image->width + padding * 2;
-    float h = (button_height > 0.0f) ? button_height : (float)image->height + padding * 2;
-    float img_w = (img_width > 0.0f) ? img_width : (float)image->width;
-    float img_h = (img_height > 0.0f) ? img_height : (float)image->height;
+    /* uint16_t indices can only address 65536 vertices per batch */
+    uint32_t max_batch_vertices = (vb->index_size == 2) ? 65536u : 0xFFFFFFFFu;
+    qui_DrawBatch *batch = NULL;
+    qui_Color32 white = QUI_RGBA(255, 255, 255, 255);
     
-    float x = ctx->cursor_x;
-    float y = ctx->cursor_y;
+    /* With an atlas font, rects sample its opaque texel so they batch with text */
+    qui_Font *font = list->font;
+    qui_Image *solid_texture = font ? &font->image : NULL;
     
-    /* Hit testing */
-    if (qui_hit_test(ctx, x, y, w, h)) {
-        ctx->hot_id = id;
-        if (ctx->mouse_pressed) {
-            ctx->active_id = id;
+    for (int i = 0; i < list->count; i++) {
+        const qui_DrawCmd *cmd = &list->commands[i];
+        
+        if (cmd->type == QUI_COMMAND_TEXT && font) {
+            float inv_w = 1.0f / (float)font->atlas_width;
+            float inv_h = 1.0f / (float)font->atlas_height;
+            qui_Color32 color = cmd->color;
+            float pen = cmd->x;
+            const unsigned char *p = (const unsigned char*)cmd->text;
+            while (*p) {
+                const qui_Glyph *g = qui_font_glyph(font, qui_font_next_char(&p));
+                if (g->width > 0 && g->height > 0) {
+                    if (vb->vertex_count + 4 > vb->vertex_capacity) {
+                        vb->dropped++;
+                        break;
+                    }
+                    if (!batch || batch->texture != solid_texture ||
+                        (uint32_t)vb->vertex_count - batch->vertex_offset + 4 > max_batch_vertices) {
+                        batch = qui_open_batch(vb, solid_texture, NULL);
+                        if (!batch) {
+                            vb->dropped++;
+                            break;
+                        }
+                    }
+                    float x0 = pen + g->offset_x;
+                    float y0 = cmd->y + g->offset_y;
+                    qui_emit_quad(vb, batch, x0, y0, x0 + g->width, y0 + g->height,
+                                  g->x * inv_w, g->y * inv_h,
+                                  (g->x + g->width) * inv_w, (g->y + g->height) * inv_h, color);
+                }
+                pen += g->advance;
+            }
+            continue;
+        }
+        
+        if (cmd->type == QUI_COMMAND_TEXT || cmd->type == QUI_COMMAND_CLIP) {
+            if (!qui_open_batch(vb, NULL, cmd)) {
+                vb->dropped++;
+            }
+            batch = NULL;
+            continue;
+        }
+        
+        if (vb->vertex_count + 4 > vb->vertex_capacity) {
+            vb->dropped++;
+            continue;
+        }
+        
+        /* Packed images draw from their page; rects stay on an open atlas page's opaque block */
+        qui_Image *texture = solid_texture;
+        if (cmd->type == QUI_COMMAND_IMAGE) {
+            texture = cmd->image->page ? cmd->image->page : cmd->image;
+        } else if (batch && batch->texture && batch->texture->page == batch->texture) {
+            texture = batch->texture;
+        }
+        if (!batch || batch->texture != texture ||
+            (uint32_t)vb->vertex_count - batch->vertex_offset + 4 > max_batch_vertices) {
+            batch = qui_open_batch(vb, texture, NULL);
+            if (!batch) {
+                vb->dropped++;
+                continue;
+            }
+        }
+        
+        qui_Color32 color = (cmd->type == QUI_COMMAND_RECT) ? cmd->color : white;
+        if (cmd->type == QUI_COMMAND_IMAGE) {
+            float uv[4] = {0.0f, 0.0f, 1.0f, 1.0f};
+            qui_image_uv(cmd->image, uv);
+            qui_emit_quad(vb, batch, cmd->x, cmd->y, cmd->x + cmd->w, cmd->y + cmd->h,
+                          uv[0], uv[1], uv[2], uv[3], color);
+        } else if (texture != solid_texture) {
+            float u = 1.0f / (float)texture->width;
+            float v = 1.0f / (float)texture->height;
+            qui_emit_quad(vb, batch, cmd->x, cmd->y, cmd->x + cmd->w, cmd->y + cmd->h, u, v, u, v, color);
+        } else if (font) {
+            qui_emit_quad(vb, batch, cmd->x, cmd->y, cmd->x + cmd->w, cmd->y + cmd->h,
+                          font->white_u, font->white_v, font->white_u, font->white_v, color);
+        } else {
+            qui_emit_quad(vb, batch, cmd->x, cmd->y, cmd->x + cmd->w, cmd->y + cmd->h,
+                          0.0f, 0.0f, 1.0f, 1.0f, color);
         }
     }
     
-    /* Calculate centered image position */
-    float centered_x = x + (w - img_w) * 0.5f;
-    float centered_y = y + (h - img_h) * 0.5f;
-    
-    /* Draw button background and image based on state */
-    if (ctx->active_id == id) {
-        qui_Rect bg_rect = qui_rect((int)w, (int)h, (int)x, (int)y);
-        qui_draw_rect_safe(ctx, &bg_rect, ctx->colors[QUI_COLOR_ACTIVE]);
-        qui_draw_image_safe(ctx, image, centered_x + 1, centered_y + 1, img_w, img_h);
-    } else if (ctx->hot_id == id) {
-        qui_Rect bg_rect = qui_rect((int)w, (int)h, (int)x, (int)y);
-        qui_draw_rect_safe(ctx, &bg_rect, ctx->colors[QUI_COLOR_HOT]);
-        qui_draw_image_safe(ctx, image, centered_x, centered_y, img_w, img_h);
-    } else {
-        qui_draw_image_safe(ctx, image, centered_x, centered_y, img_w, img_h);
+    return QUI_OK;
+}
+
+/* ================================================================================================
+ * FONTS IMPLEMENTATION
+ * ================================================================================================ */
+
+/** @brief Built-in bitmap font metrics (unscaled) */
+#define QUI_SW_GLYPH_WIDTH 5
+#define QUI_SW_GLYPH_HEIGHT 7
+#define QUI_SW_GLYPH_ADVANCE 6
+#define QUI_SW_LINE_HEIGHT 8
+
+/** @brief Built-in 5x7 font for ASCII 32-126, one byte per row, bit 4 is the leftmost pixel */
+static const unsigned char QUI_SW_FONT[95][QUI_SW_GLYPH_HEIGHT] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, /* space */
+    {0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04}, /* ! */
+    {0x0A, 0x0A, 0x0A, 0x00, 0x00, 0x00, 0x00}, /* " */
+    {0x0A, 0x0A, 0x1F, 0x0A, 0x1F, 0x0A, 0x0A}, /* # */
+    {0x04, 0x0F, 0x14, 0x0E, 0x05, 0x1E, 0x04}, /* $ */
+    {0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03}, /* % */
+    {0x0C, 0x12, 0x14, 0x08, 0x15, 0x12, 0x0D}, /* & */
+    {0x0C, 0x04, 0x08, 0x00, 0x00, 0x00, 0x00}, /* ' */
+    {0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02}, /* ( */
+    {0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08}, /* ) */
+    {0x00, 0x04, 0x15, 0x0E, 0x15, 0x04, 0x00}, /* * */
+    {0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00}, /* + */
+    {0x00, 0x00, 0x00, 0x00, 0x0C, 0x04, 0x08}, /* , */
+    {0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00}, /* - */
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C}, /* . */
+    {0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00}, /* / */
+    {0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E}, /* 0 */
+    {0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E}, /* 1 */
+    {0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F}, /* 2 */
+    {0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E}, /* 3 */
+    {0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02}, /* 4 */
+    {0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E}, /* 5 */
+    {0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E}, /* 6 */
+    {0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08}, /* 7 */
+    {0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E}, /* 8 */
+    {0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C}, /* 9 */
+    {0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00}, /* : */
+    {0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x04, 0x08}, /* ; */
+    {0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02}, /* < */
+    {0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00}, /* = */
+    {0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08}, /* > */
+    {0x0E, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04}, /* ? */
+    {0x0E, 0x11, 0x01, 0x0D, 0x15, 0x15, 0x0E}, /* @ */
+    {0x0E, 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11}, /* A */
+    {0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E}, /* B */
+    {0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E}, /* C */
+    {0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C}, /* D */
+    {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F}, /* E */
+    {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10}, /* F */
+    {0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F}, /* G */
+    {0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11}, /* H */
+    {0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E}, /* I */
+    {0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C}, /* J */
+    {0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11}, /* K */
+    {0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F}, /* L */
+    {0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11}, /* M */
+    {0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11}, /* N */
+    {0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}, /* O */
+    {0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10}, /* P */
+    {0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D}, /* Q */
+    {0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11}, /* R */
+    {0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E}, /* S */
+    {0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04}, /* T */
+    {0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}, /* U */
+    {0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04}, /* V */
+    {0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A}, /* W */
+    {0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11}, /* X */
+    {0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04}, /* Y */
+    {0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F}, /* Z */
+    {0x0E, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0E}, /* [ */
+    {0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00}, /* \\ */
+    {0x0E, 0x02, 0x02, 0x02, 0x02, 0x02, 0x0E}, /* ] */
+    {0x04, 0x0A, 0x11, 0x00, 0x00, 0x00, 0x00}, /* ^ */
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F}, /* _ */
+    {0x08, 0x04, 0x02, 0x00, 0x00, 0x00, 0x00}, /* ` */
+    {0x00, 0x00, 0x0E, 0x01, 0x0F, 0x11, 0x0F}, /* a */
+    {0x10, 0x10, 0x16, 0x19, 0x11, 0x11, 0x1E}, /* b */
+    {0x00, 0x00, 0x0E, 0x10, 0x10, 0x11, 0x0E}, /* c */
+    {0x01, 0x01, 0x0D, 0x13, 0x11, 0x11, 0x0F}, /* d */
+    {0x00, 0x00, 0x0E, 0x11, 0x1F, 0x10, 0x0E}, /* e */
+    {0x06, 0x09, 0x08, 0x1C, 0x08, 0x08, 0x08}, /* f */
+    {0x00, 0x0F, 0x11, 0x11, 0x0F, 0x01, 0x0E}, /* g */
+    {0x10, 0x10, 0x16, 0x19, 0x11, 0x11, 0x11}, /* h */
+    {0x04, 0x00, 0x0C, 0x04, 0x04, 0x04, 0x0E}, /* i */
+    {0x02, 0x00, 0x06, 0x02, 0x02, 0x12, 0x0C}, /* j */
+    {0x10, 0x10, 0x12, 0x14, 0x18, 0x14, 0x12}, /* k */
+    {0x0C, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E}, /* l */
+    {0x00, 0x00, 0x1A, 0x15, 0x15, 0x11, 0x11}, /* m */
+    {0x00, 0x00, 0x16, 0x19, 0x11, 0x11, 0x11}, /* n */
+    {0x00, 0x00, 0x0E, 0x11, 0x11, 0x11, 0x0E}, /* o */
+    {0x00, 0x00, 0x1E, 0x11, 0x1E, 0x10, 0x10}, /* p */
+    {0x00, 0x00, 0x0D, 0x13, 0x0F, 0x01, 0x01}, /* q */
+    {0x00, 0x00, 0x16, 0x19, 0x10, 0x10, 0x10}, /* r */
+    {0x00, 0x00, 0x0E, 0x10, 0x0E, 0x01, 0x1E}, /* s */
+    {0x08, 0x08, 0x1C, 0x08, 0x08, 0x09, 0x06}, /* t */
+    {0x00, 0x00, 0x11, 0x11, 0x11, 0x13, 0x0D}, /* u */
+    {0x00, 0x00, 0x11, 0x11, 0x11, 0x0A, 0x04}, /* v */
+    {0x00, 0x00, 0x11, 0x11, 0x15, 0x15, 0x0A}, /* w */
+    {0x00, 0x00, 0x11, 0x0A, 0x04, 0x0A, 0x11}, /* x */
+    {0x00, 0x00, 0x11, 0x11, 0x0F, 0x01, 0x0E}, /* y */
+    {0x00, 0x00, 0x1F, 0x02, 0x04, 0x08, 0x1F}, /* z */
+    {0x02, 0x04, 0x04, 0x08, 0x04, 0x04, 0x02}, /* { */
+    {0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04}, /* | */
+    {0x08, 0x04, 0x04, 0x02, 0x04, 0x04, 0x08}, /* } */
+    {0x00, 0x00, 0x08, 0x15, 0x02, 0x00, 0x00}, /* ~ */
+};
+
+/** @brief Start an empty skyline over a width x height area */
+static void qui_skyline_init(qui_Skyline *sky, int width, int height) {
+    sky->width = width;
+    sky->height = height;
+    sky->count = 1;
+    sky->nodes[0].x = 0;
+    sky->nodes[0].y = 0;
+    sky->nodes[0].width = width;
+}
+
+/** @brief Lowest top edge for a w x h rect starting at node i, or -1 if it does not fit */
+static int qui_skyline_fit(const qui_Skyline *sky, int i, int w, int h) {
+    int x = sky->nodes[i].x;
+    if (x + w > sky->width) return -1;
+    
+    int y = 0;
+    for (int left = w; left > 0; i++) {
+        if (sky->nodes[i].y > y) y = sky->nodes[i].y;
+        if (y + h > sky->height) return -1;
+        left -= sky->nodes[i].width;
     }
-    
-    /* Check for click */
-    int clicked = 0;
-    if (ctx->mouse_released && ctx->active_id == id) {
-        if (qui_hit_test(ctx, x, y, w, h)) {
-            clicked = 1;
+    return y;
+}
+
+/** @brief Place a w x h rect at the lowest (then narrowest) spot; false if it does not fit */
+static bool qui_skyline_pack(qui_Skyline *sky, int w, int h, int *out_x, int *out_y) {
+    if (w <= 0 || h <= 0) return false;
+    
+    int best = -1;
+    int best_y = 0;
+    int best_width = 0;
+    for (int i = 0; i < sky->count; i++) {
+        int y = qui_skyline_fit(sky, i, w, h);
+        if (y < 0) continue;
+        if (best < 0 || y + h < best_y + h || (y == best_y && sky->nodes[i].width < best_width)) {
+            best = i;
+            best_y = y;
+            best_width = sky->nodes[i].width;
+        }
+    }
+    if (best < 0 || sky->count >= QUI_SKYLINE_MAX_NODES) return false;
+    
+    /* New segment on top of the rect, then trim the segments it covers */
+    memmove(sky->nodes + best + 1, sky->nodes + best, sizeof(qui_SkylineNode) * (size_t)(sky->count - best));
+    sky->count++;
+    sky->nodes[best].y = best_y + h;
+    sky->nodes[best].width = w;
+    *out_x = sky->nodes[best].x;
+    *out_y = best_y;
+    
+    int right = sky->nodes[best].x + w;
+    int i = best + 1;
+    while (i < sky->count && sky->nodes[i].x < right) {
+        int shrink = right - sky->nodes[i].x;
+        if (shrink >= sky->nodes[i].width) {
+            memmove(sky->nodes + i, sky->nodes + i + 1, sizeof(qui_SkylineNode) * (size_t)(sky->count - i - 1));
+            sky->count--;
+        } else {
+            sky->nodes[i].x += shrink;
+            sky->nodes[i].width -= shrink;
+            break;
         }
-        ctx->active_id = 0;
     }
     
-    /* Update layout cursor */
-    ctx->cursor_y += h + ctx->spacing_y;
-    ctx->cursor_x = ctx->spacing_x;
+    /* Merge neighbours of equal height */
+    for (i = 0; i + 1 < sky->count; ) {
+        if (sky->nodes[i].y == sky->nodes[i + 1].y) {
+            sky->nodes[i].width += sky->nodes[i + 1].width;
+            memmove(sky->nodes + i + 1, sky->nodes + i + 2, sizeof(qui_SkylineNode) * (size_t)(sky->count - i - 2));
+            sky->count--;
+        } else {
+            i++;
+        }
+    }
     
-    return clicked;
+    return true;
 }
 
-int qui_image_button_with_label(qui_Context *ctx, qui_Image *image, const char *label, float img_width, float img_height) {
-    if (!ctx || !image || !label) return -1;
+qui_Result qui_font_init(qui_Font *font, int atlas_width, int atlas_height, float line_height) {
+    QUI_VALIDATE_PTR(font);
     
-    if (image->width <= 0 || image->height <= 0 || !image->data) {
-        /* Fallback to text button if image is invalid */
-        return qui_button(ctx, label);
+    if (atlas_width <= 0 || atlas_height <= 0 || atlas_width > 65535 || atlas_height > 65535) {
+        return QUI_ERROR_INVALID_VALUE;
     }
     
-    qui_Id id = qui_gen_id(ctx);
-    float img_w = (img_width > 0.0f) ? img_width : (float)image->width;
-    float img_h = (img_height > 0.0f) ? img_height : (float)image->height;
-    float text_width = qui_get_text_width(ctx, label);
-    float text_height = qui_get_text_height(ctx, label);
+    memset(font, 0, sizeof(*font));
+    font->pixels = (unsigned char*)QUI_MALLOC((size_t)atlas_width * (size_t)atlas_height);
+    if (!font->pixels) {
+        return QUI_ERROR_OUT_OF_MEMORY;
+    }
+    memset(font->pixels, 0, (size_t)atlas_width * (size_t)atlas_height);
+    
+    font->atlas_width = atlas_width;
+    font->atlas_height = atlas_height;
+    font->image.data = font->pixels;
+    font->image.width = atlas_width;
+    font->image.height = atlas_height;
+    font->image.channels = 1;
+    font->fallback = '?';
+    font->line_height = line_height;
+    qui_skyline_init(&font->packer, atlas_width, atlas_height);
+    
+    /* Opaque 2x2 block; sampling its centre stays opaque under bilinear filtering */
+    int wx, wy;
+    if (!qui_skyline_pack(&font->packer, 3, 3, &wx, &wy)) {
+        qui_font_free(font);
+        return QUI_ERROR_INVALID_VALUE;
+    }
+    for (int y = 0; y < 2; y++) {
+        memset(font->pixels + (size_t)(wy + y) * (size_t)atlas_width + wx, 0xFF, 2);
+    }
+    font->white_u = ((float)wx + 1.0f) / (float)atlas_width;
+    font->white_v = ((float)wy + 1.0f) / (float)atlas_height;
     
-    float padding = 8.0f;
-    float spacing = 6.0f;
-    float total_width = img_w + spacing + text_width + (padding * 2);
-    float total_height = fmaxf(img_h, text_height) + (padding * 2);
+    return QUI_OK;
+}
+
+qui_Result qui_font_add_glyph(qui_Font *font, uint32_t codepoint, const unsigned char *coverage,
+                              int width, int height, int stride,
+                              float offset_x, float offset_y, float advance) {
+    QUI_VALIDATE_PTR(font);
     
-    float x = ctx->cursor_x;
-    float y = ctx->cursor_y;
+    if (!font->pixels) {
+        return QUI_ERROR_NOT_INITIALIZED;
+    }
+    if (codepoint >= QUI_FONT_GLYPH_COUNT || width < 0 || height < 0) {
+        return QUI_ERROR_INVALID_VALUE;
+    }
     
-    /* Hit testing */
-    if (qui_hit_test(ctx, x, y, total_width, total_height)) {
-        ctx->hot_id = id;
-        if (ctx->mouse_pressed) {
-            ctx->active_id = id;
+    qui_Glyph *g = &font->glyphs[codepoint];
+    memset(g, 0, sizeof(*g));
+    
+    if (width > 0 && height > 0) {
+        QUI_VALIDATE_PTR(coverage);
+        if (stride <= 0) stride = width;
+        
+        int x, y;
+        if (!qui_skyline_pack(&font->packer, width + 1, height + 1, &x, &y)) {
+            return QUI_ERROR_BUFFER_TOO_SMALL;
+        }
+        for (int row = 0; row < height; row++) {
+            memcpy(font->pixels + (size_t)(y + row) * (size_t)font->atlas_width + x,
+                   coverage + (size_t)row * (size_t)stride, (size_t)width);
         }
+        g->x = (uint16_t)x;
+        g->y = (uint16_t)y;
+        g->width = (uint16_t)width;
+        g->height = (uint16_t)height;
     }
     
-    /* Determine color based on state */
-    qui_Color color = ctx->colors[QUI_COLOR_FOREGROUND];
-    if (ctx->active_id == id) {
-        color = ctx->colors[QUI_COLOR_ACTIVE];
-    } else if (ctx->hot_id == id) {
-        color = ctx->colors[QUI_COLOR_HOT];
+    g->offset_x = offset_x;
+    g->offset_y = offset_y;
+    g->advance = advance;
+    g->defined = 1;
+    
+    return QUI_OK;
+}
+
+qui_Result qui_font_init_default(qui_Font *font, int scale) {
+    QUI_VALIDATE_PTR(font);
+    
+    if (scale <= 0 || scale > 64) {
+        return QUI_ERROR_INVALID_VALUE;
     }
     
-    /* Draw button background */
-    qui_Rect bg_rect = qui_rect((int)total_width, (int)total_height, (int)x, (int)y);
-    qui_draw_rect_safe(ctx, &bg_rect, color);
+    /* Room for 95 glyphs plus packing slack */
+    int cell = (QUI_SW_GLYPH_WIDTH * scale + 1) * (QUI_SW_GLYPH_HEIGHT * scale + 1);
+    int side = 64;
+    while (side * side < 2 * 96 * cell) side *= 2;
     
-    /* Calculate positions */
-    float img_x = x + padding;
-    float img_y = y + (total_height - img_h) * 0.5f;
-    float text_x = img_x + img_w + spacing;
-    float text_y = y + (total_height - text_height) * 0.5f;
+    qui_Result result = qui_font_init(font, side, side, (float)(QUI_SW_LINE_HEIGHT * scale));
+    if (result != QUI_OK) return result;
     
-    /* Apply press offset for active state */
-    if (ctx->active_id == id) {
-        img_x += 1;
-        img_y += 1;
-        text_x += 1;
-        text_y += 1;
+    unsigned char *bitmap = (unsigned char*)QUI_MALLOC((size_t)cell);
+    if (!bitmap) {
+        qui_font_free(font);
+        return QUI_ERROR_OUT_OF_MEMORY;
     }
     
-    /* Draw image and text */
-    qui_draw_image_safe(ctx, image, img_x, img_y, img_w, img_h);
-    qui_draw_text_safe(ctx, label, text_x, text_y);
-    
-    /* Check for click */
-    int clicked = 0;
-    if (ctx->mouse_released && ctx->active_id == id) {
-        if (qui_hit_test(ctx, x, y, total_width, total_height)) {
-            clicked = 1;
+    int w = QUI_SW_GLYPH_WIDTH * scale;
+    int h = QUI_SW_GLYPH_HEIGHT * scale;
+    for (int c = 32; c < 127; c++) {
+        const unsigned char *rows = QUI_SW_FONT[c - 32];
+        for (int y = 0; y < h; y++) {
+            for (int x = 0; x < w; x++) {
+                bitmap[y * w + x] = (rows[y / scale] & (0x10 >> (x / scale))) ? 0xFF : 0x00;
+            }
         }
-        ctx->active_id = 0;
+        result = qui_font_add_glyph(font, (uint32_t)c, (c == ' ') ? NULL : bitmap, (c == ' ') ? 0 : w, (c == ' ') ? 0 : h,
+                                    w, 0.0f, 0.0f, (float)(QUI_SW_GLYPH_ADVANCE * scale));
+        if (result != QUI_OK) break;
     }
     
-    /* Update layout cursor */
-    ctx->cursor_y += total_height + ctx->spacing_y;
-    ctx->cursor_x = ctx->spacing_x;
-    
-    return clicked;
+    QUI_FREE(bitmap);
+    if (result != QUI_OK) qui_font_free(font);
+    return result;
 }
 
-int qui_image_button_vertical(qui_Context *ctx, qui_Image *image, const char *label, float img_width, float img_height) {
-    if (!ctx || !image || !label) return -1;
+qui_Result qui_font_free(qui_Font *font) {
+    QUI_VALIDATE_PTR(font);
     
-    if (image->width <= 0 || image->height <= 0 || !image->data) {
-        /* Fallback to text button if image is invalid */
-        return qui_button(ctx, label);
+    QUI_FREE(font->pixels);
+    memset(font, 0, sizeof(*font));
+    
+    return QUI_OK;
+}
+
+qui_Result qui_use_font(qui_Context *ctx, qui_Font *font) {
+    QUI_VALIDATE_CTX(ctx);
+    
+    if (font && !font->pixels) {
+        return QUI_ERROR_NOT_INITIALIZED;
     }
     
-    qui_Id id = qui_gen_id(ctx);
-    float img_w = (img_width > 0.0f) ? img_width : (float)image->width;
-    float img_h = (img_height > 0.0f) ? img_height : (float)image->height;
+    ctx->atlas_font = font;
+    ctx->draw_list.font = font;
+    
+    return QUI_OK;
+}
+
+/* ================================================================================================
+ * IMAGE ATLAS IMPLEMENTATION
+ * ================================================================================================ */
+
+qui_Result qui_image_atlas_init(qui_ImageAtlas *atlas, int page_width, int page_height) {
+    QUI_VALIDATE_PTR(atlas);
+    
+    if (page_width <= 2 || page_height <= 2) {
+        return QUI_ERROR_INVALID_VALUE;
+    }
+    
+    memset(atlas, 0, sizeof(*atlas));
+    atlas->page_width = page_width;
+    atlas->page_height = page_height;
+    
+    return QUI_OK;
+}
+
+/** @brief Allocate the next page and reserve its opaque block */
+static qui_Result qui_image_atlas_grow(qui_ImageAtlas *atlas) {
+    if (atlas->page_count >= QUI_IMAGE_ATLAS_MAX_PAGES) {
+        return QUI_ERROR_BUFFER_TOO_SMALL;
+    }
+    
+    size_t bytes = (size_t)atlas->page_width * (size_t)atlas->page_height * 4;
+    unsigned char *pixels = (unsigned char*)QUI_MALLOC(bytes);
+    if (!pixels) {
+        return QUI_ERROR_OUT_OF_MEMORY;
+    }
+    memset(pixels, 0, bytes);
+    
+    qui_Image *page = &atlas->pages[atlas->page_count];
+    qui_Skyline *sky = &atlas->packers[atlas->page_count];
+    atlas->page_count++;
+    
+    page->data = pixels;
+    page->width = atlas->page_width;
+    page->height = atlas->page_height;
+    page->channels = 4;
+    page->page = page;
+    page->page_x = 0;
+    page->page_y = 0;
+    
+    /* The first rect on an empty skyline lands at the origin */
+    int x, y;
+    qui_skyline_init(sky, atlas->page_width, atlas->page_height);
+    qui_skyline_pack(sky, 3, 3, &x, &y);
+    memset(pixels, 0xFF, 8);
+    memset(pixels + (size_t)atlas->page_width * 4, 0xFF, 8);
+    
+    return QUI_OK;
+}
+
+qui_Result qui_image_atlas_add(qui_ImageAtlas *atlas, const qui_Image *source, qui_Image *out) {
+    QUI_VALIDATE_PTR(atlas);
+    QUI_VALIDATE_PTR(source);
+    QUI_VALIDATE_PTR(out);
+    
+    if (atlas->page_width <= 0) {
+        return QUI_ERROR_NOT_INITIALIZED;
+    }
+    if (!source->data || source->width <= 0 || source->height <= 0 ||
+        source->channels < 1 || source->channels > 4 || source->page) {
+        return QUI_ERROR_INVALID_VALUE;
+    }
+    
+    /* Must fit an empty page beside or below the opaque block */
+    int w = source->width + 1;
+    int h = source->height + 1;
+    if (w > atlas->page_width || h > atlas->page_height ||
+        (w > atlas->page_width - 3 && h > atlas->page_height - 3)) {
+        return QUI_ERROR_INVALID_VALUE;
+    }
+    
+    int page = 0;
+    int x = 0, y = 0;
+    for (; page < atlas->page_count; page++) {
+        if (qui_skyline_pack(&atlas->packers[page], w, h, &x, &y)) break;
+    }
+    if (page == atlas->page_count) {
+        qui_Result result = qui_image_atlas_grow(atlas);
+        if (result != QUI_OK) return result;
+        if (!qui_skyline_pack(&atlas->packers[page], w, h, &x, &y)) {
+            return QUI_ERROR_BUFFER_TOO_SMALL;
+        }
+    }
+    
+    qui_Image *dst = &atlas->pages[page];
+    const unsigned char *src = (const unsigned char*)source->data;
+    int channels = source->channels;
+    size_t pitch = (size_t)dst->width * 4;
+    unsigned char *first = (unsigned char*)dst->data + (size_t)y * pitch + (size_t)x * 4;
+    
+    for (int row = 0; row < source->height; row++) {
+        unsigned char *d = first + (size_t)row * pitch;
+        const unsigned char *p = src + (size_t)row * (size_t)source->width * (size_t)channels;
+        if (channels == 4) {
+            memcpy(d, p, (size_t)source->width * 4);
+            continue;
+        }
+        for (int i = 0; i < source->width; i++, d += 4, p += channels) {
+            d[0] = p[0];
+            d[1] = (channels == 3) ? p[1] : p[0];
+            d[2] = (channels == 3) ? p[2] : p[0];
+            d[3] = (channels == 2) ? p[1] : 0xFF;
+        }
+    }
+    
+    out->width = source->width;
+    out->height = source->height;
+    out->data = first;
+    out->channels = 4;
+    out->page = dst;
+    out->page_x = x;
+    out->page_y = y;
+    
+    return QUI_OK;
+}
+
+qui_Result qui_image_atlas_free(qui_ImageAtlas *atlas) {
+    QUI_VALIDATE_PTR(atlas);
+    
+    for (int i = 0; i < atlas->page_count; i++) {
+        QUI_FREE(atlas->pages[i].data);
+    }
+    memset(atlas, 0, sizeof(*atlas));
+    
+    return QUI_OK;
+}
+
+qui_Result qui_image_uv(const qui_Image *image, float uv[4]) {
+    QUI_VALIDATE_PTR(image);
+    QUI_VALIDATE_PTR(uv);
+    
+    const qui_Image *page = image->page;
+    if (!page || page == image || page->width <= 0 || page->height <= 0) {
+        uv[0] = 0.0f;
+        uv[1] = 0.0f;
+        uv[2] = 1.0f;
+        uv[3] = 1.0f;
+        return QUI_OK;
+    }
+    
+    float inv_w = 1.0f / (float)page->width;
+    float inv_h = 1.0f / (float)page->height;
+    uv[0] = (float)image->page_x * inv_w;
+    uv[1] = (float)image->page_y * inv_h;
+    uv[2] = (float)(image->page_x + image->width) * inv_w;
+    uv[3] = (float)(image->page_y + image->height) * inv_h;
+    
+    return QUI_OK;
+}
+
+/* ================================================================================================
+ * UI ELEMENTS IMPLEMENTATION
+ * ================================================================================================ */
+
+int qui_button(qui_Context *ctx, const char *label) {
+    if (!ctx || !label) return -1;
+    
+    qui_Id id = qui_gen_id_str(ctx, label);
     float text_width = qui_get_text_width(ctx, label);
     float text_height = qui_get_text_height(ctx, label);
+    float padding = 10.0f;
     
-    float padding = 8.0f;
-    float spacing = 4.0f;
-    float total_width = fmaxf(img_w, text_width) + (padding * 2);
-    float total_height = img_h + spacing + text_height + (padding * 2);
+    float w = text_width + (padding * 2);
+    float h = text_height + 8.0f;
+    float x, y;
+    qui_layout_next(ctx, w, h, &x, &y);
     
-    float x = ctx->cursor_x;
-    float y = ctx->cursor_y;
+    /* Widgets outside the clip region only advance the layout */
+    if (qui_cull_widget(ctx, id, x, y, w, h)) {
+        qui_layout_advance(ctx, w, h);
+        return 0;
+    }
     
     /* Hit testing */
-    if (qui_hit_test(ctx, x, y, total_width, total_height)) {
+    if (qui_widget_hovered(ctx, id, x, y, w, h)) {
         ctx->hot_id = id;
         if (ctx->mouse_pressed) {
             ctx->active_id = id;
@@ -1282,133 +5399,2173 @@ int qui_image_button_vertical(qui_Context *ctx, qui_Image *image, const char *la
     }
     
     /* Determine color based on state */
-    qui_Color color = ctx->colors[QUI_COLOR_FOREGROUND];
-    if (ctx->active_id == id) {
-        color = ctx->colors[QUI_COLOR_ACTIVE];
-    } else if (ctx->hot_id == id) {
-        color = ctx->colors[QUI_COLOR_HOT];
-    }
+    qui_Color32 color = qui_state_color(ctx, id);
     
     /* Draw button background */
-    qui_Rect bg_rect = qui_rect((int)total_width, (int)total_height, (int)x, (int)y);
-    qui_draw_rect_safe(ctx, &bg_rect, color);
-    
-    /* Calculate centered positions */
-    float img_x = x + (total_width - img_w) * 0.5f;
-    float img_y = y + padding;
-    float text_x = x + (total_width - text_width) * 0.5f;
-    float text_y = img_y + img_h + spacing;
-    
-    /* Apply press offset for active state */
-    if (ctx->active_id == id) {
-        img_x += 1;
-        img_y += 1;
-        text_x += 1;
-        text_y += 1;
-    }
+    qui_Rect rect = qui_rect((int)w, (int)h, (int)x, (int)y);
+    qui_draw_rect_safe(ctx, &rect, color);
     
-    /* Draw image and text */
-    qui_draw_image_safe(ctx, image, img_x, img_y, img_w, img_h);
-    qui_draw_text_safe(ctx, label, text_x, text_y);
+    /* Draw button text */
+    qui_draw_text_safe(ctx, label, x + padding, y + 4.0f);
     
     /* Check for click */
     int clicked = 0;
     if (ctx->mouse_released && ctx->active_id == id) {
-        if (qui_hit_test(ctx, x, y, total_width, total_height)) {
+        if (ctx->hover_id == id) {
             clicked = 1;
         }
         ctx->active_id = 0;
     }
     
     /* Update layout cursor */
-    ctx->cursor_y += total_height + ctx->spacing_y;
-    ctx->cursor_x = ctx->spacing_x;
+    qui_layout_advance(ctx, w, h);
     
     return clicked;
 }
 
-/* ================================================================================================
- * WINDOW MANAGEMENT IMPLEMENTATION
- * ================================================================================================ */
-
-bool qui_begin_window(qui_Context *ctx, const char *title, qui_Vec2 size, qui_Vec2 *pos) {
-    if (!ctx || !pos) return false;
-    
-    if (size.x <= 0 || size.y <= 0) return false;
+int qui_checkbox(qui_Context *ctx, const char *label, int *value) {
+    if (!ctx || !label || !value) return -1;
     
-    qui_Id window_id = qui_gen_id(ctx);
+    qui_Id id = qui_gen_id_str(ctx, label);
+    float box_size = 18.0f;
+    float text_width = qui_get_text_width(ctx, label);
+    float text_height = qui_get_text_height(ctx, label);
+    float spacing = 6.0f;
     
-    float x = (float)pos->x;
-    float y = (float)pos->y;
-    float w = (float)size.x;
-    float h = (float)size.y;
-    float title_height = qui_get_text_height(ctx, title ? title : "Window") + 8.0f;
+    float total_width = box_size + spacing + text_width;
+    float h = fmaxf(box_size, text_height);
+    float x, y;
+    qui_layout_next(ctx, total_width, h, &x, &y);
     
-    /* Handle window dragging */
-    if (ctx->active_id == 0 || ctx->active_id == window_id) {
-        bool title_bar_hit = qui_hit_test_absolute(ctx, x, y, w - 4, title_height);
-        
-        if (title_bar_hit) {
-            ctx->hot_id = window_id;
-            if (ctx->mouse_pressed) {
-                ctx->active_id = window_id;
-                ctx->drag_offset_x = (float)ctx->mouse_pos.x - x;
-                ctx->drag_offset_y = (float)ctx->mouse_pos.y - y;
-            }
-        }
+    /* Widgets outside the clip region only advance the layout */
+    if (qui_cull_widget(ctx, id, x, y, total_width, h)) {
+        qui_layout_advance(ctx, total_width, h);
+        return 0;
     }
     
-    /* Update window position if being dragged */
-    if (ctx->active_id == window_id && ctx->mouse_down) {
-        pos->x = (int)((float)ctx->mouse_pos.x - ctx->drag_offset_x);
-        pos->y = (int)((float)ctx->mouse_pos.y - ctx->drag_offset_y);
-        x = (float)pos->x;
-        y = (float)pos->y;
+    /* Hit testing */
+    if (qui_widget_hovered(ctx, id, x, y, total_width, h)) {
+        ctx->hot_id = id;
+        if (ctx->mouse_pressed) {
+            ctx->active_id = id;
+        }
     }
     
-    /* Draw window background */
-    qui_Rect window_bg = qui_rect((int)w, (int)h, (int)x, (int)y);
-    qui_draw_rect_safe(ctx, &window_bg, ctx->colors[QUI_COLOR_WINDOW_BG]);
+    /* Determine color based on state */
+    qui_Color32 color = qui_state_color(ctx, id);
     
-    /* Draw title bar */
-    qui_Rect title_bar = qui_rect((int)w, (int)title_height, (int)x, (int)y);
-    qui_draw_rect_safe(ctx, &title_bar, ctx->colors[QUI_COLOR_TITLE_BAR]);
+    /* Draw checkbox box */
+    qui_Rect box_rect = qui_rect((int)box_size, (int)box_size, (int)x, (int)y);
+    qui_draw_rect_safe(ctx, &box_rect, color);
     
-    /* Draw title text */
-    if (title) {
-        qui_draw_text_safe(ctx, title, x + 8.0f, y + 4.0f);
+    /* Draw check mark if checked */
+    if (*value) {
+        qui_draw_text_safe(ctx, "X", x + 4.0f, y + 1.0f);
     }
     
-    /* Release drag on mouse up */
-    if (ctx->mouse_released && ctx->active_id == window_id) {
+    /* Draw label */
+    qui_draw_text_safe(ctx, label, x + box_size + spacing, y + 1.0f);
+    
+    /* Check for click */
+    int changed = 0;
+    if (ctx->mouse_released && ctx->active_id == id) {
+        if (ctx->hover_id == id) {
+            *value = !(*value);
+            changed = 1;
+        }
         ctx->active_id = 0;
     }
     
-    /* Save current layout state */
-    ctx->saved_cursor_x = ctx->cursor_x;
-    ctx->saved_cursor_y = ctx->cursor_y;
-    ctx->saved_offset_x = ctx->layout_offset_x;
-    ctx->saved_offset_y = ctx->layout_offset_y;
-    
-    /* Set up window-relative coordinate system */
-    ctx->layout_offset_x = x + 10.0f;
-    ctx->layout_offset_y = y + title_height + 10.0f;
-    ctx->cursor_x = 0.0f;
-    ctx->cursor_y = 0.0f;
+    /* Update layout cursor */
+    qui_layout_advance(ctx, total_width, h);
     
-    return true;
+    return changed;
 }
 
-qui_Result qui_end_window(qui_Context *ctx) {
-    QUI_VALIDATE_CTX(ctx);
+int qui_slider(qui_Context *ctx, const char *label, float *value, float min_val, float max_val, float width) {
+    if (!ctx || !label || !value) return -1;
     
-    /* Restore previous layout state */
-    ctx->cursor_x = ctx->saved_cursor_x;
-    ctx->cursor_y = ctx->saved_cursor_y;
-    ctx->layout_offset_x = ctx->saved_offset_x;
-    ctx->layout_offset_y = ctx->saved_offset_y;
+    if (min_val >= max_val || !isfinite(min_val) || !isfinite(max_val) || 
+        !isfinite(*value) || width < 0.0f) {
+        return -1;
+    }
     
-    return QUI_OK;
+    qui_Id id = qui_gen_id_str(ctx, label);
+    float label_width = qui_get_text_width(ctx, label);
+    float text_height = qui_get_text_height(ctx, label);
+    float slider_width = (width > 0.0f) ? width : 160.0f;
+    float slider_height = 12.0f;
+    float knob_width = 10.0f;
+    float spacing = 12.0f;
+    float value_display_width = 60.0f;
+    
+    float w = label_width + spacing + slider_width + 8.0f + value_display_width;
+    float h = text_height + 8.0f;
+    float x, y;
+    qui_layout_next(ctx, w, h, &x, &y);
+    float slider_x = x + label_width + spacing;
+    
+    /* Clamp value to valid range */
+    if (*value < min_val) *value = min_val;
+    if (*value > max_val) *value = max_val;
+    
+    /* Widgets outside the clip region only advance the layout */
+    if (qui_cull_widget(ctx, id, x, y, w, h)) {
+        qui_layout_advance(ctx, w, h);
+        return 1;
+    }
+    
+    /* Hit testing on slider area */
+    if (qui_widget_hovered(ctx, id, slider_x, y, slider_width, slider_height)) {
+        ctx->hot_id = id;
+        if (ctx->mouse_pressed) {
+            ctx->active_id = id;
+        }
+    }
+    
+    /* Determine color based on state */
+    qui_Color32 color = qui_state_color(ctx, id);
+    
+    /* Draw label */
+    qui_draw_text_safe(ctx, label, x, y);
+    
+    /* Draw slider background */
+    qui_Rect slider_bg = qui_rect((int)slider_width, (int)slider_height, (int)slider_x, (int)(y + 2));
+    qui_draw_rect_safe(ctx, &slider_bg, color);
+    
+    /* Calculate knob position */
+    float t = (*value - min_val) / (max_val - min_val);
+    if (t < 0.0f) t = 0.0f;
+    if (t > 1.0f) t = 1.0f;
+    float knob_x = slider_x + t * (slider_width - knob_width);
+    
+    /* Handle dragging */
+    if (ctx->active_id == id && ctx->mouse_down) {
+        float local_x = (float)ctx->mouse_pos.x - (slider_x + ctx->layout_offset_x);
+        float new_t = local_x / (slider_width - knob_width);
+        if (new_t < 0.0f) new_t = 0.0f;
+        if (new_t > 1.0f) new_t = 1.0f;
+        *value = min_val + new_t * (max_val - min_val);
+    }
+    
+    if (ctx->mouse_released && ctx->active_id == id) {
+        ctx->active_id = 0;
+    }
+    
+    /* Draw knob */
+    qui_Rect knob_rect = qui_rect((int)knob_width, (int)(slider_height + 4), (int)knob_x, (int)y);
+    qui_draw_rect_safe(ctx, &knob_rect, ctx->colors[QUI_COLOR_ACTIVE]);
+    
+    /* Draw value display */
+    const char *value_text = qui_frame_printf(ctx, "%.2f", *value);
+    if (value_text) {
+        qui_draw_text_safe(ctx, value_text, slider_x + slider_width + 8.0f, y);
+    }
+    
+    /* Update layout cursor */
+    qui_layout_advance(ctx, w, h);
+    
+    return 1;
 }
 
+/** @brief Per-textbox editing state kept in the widget state store */
+typedef struct {
+    uint32_t length;        /**< strlen(buffer), measured each frame while focused */
+    uint32_t caret;         /**< Caret byte offset */
+    uint32_t anchor;        /**< Selection anchor byte offset (== caret when nothing is selected) */
+    uint32_t scroll;        /**< Byte offset of the first visible character */
+    uint32_t focused;       /**< Had keyboard focus last frame */
+} qui_TextboxState;
+
+/**
+ * @brief Width of the character at pos (measured alone, so the text cache serves repeats)
+ *
+ * Summed over the characters of a run that starts at origin, this matches
+ * qui_get_text_width() of that run. Atlas fonts draw no spacing and advance tables already
+ * include it. A measure callback spaces the characters of a string, so the spacing before
+ * each character after the first is added here, as is the kerning hook's pair with the
+ * previous byte.
+ */
+static float qui_char_advance(qui_Context *ctx, const char *text, size_t origin, size_t pos, size_t next) {
+    char glyph[5];
+    size_t n = next - pos;
+    if (n > 4) n = 4;
+    memcpy(glyph, text + pos, n);
+    glyph[n] = '\0';
+    float width = qui_get_text_width(ctx, glyph);
+    
+    if (ctx->atlas_font) return width;
+    if (ctx->advance_table) {
+        if (ctx->kerning && pos > origin) {
+            width += ctx->kerning(ctx, (unsigned char)text[pos - 1], (unsigned char)text[pos]);
+        }
+        return width;
+    }
+    return (ctx->text_width && pos > origin) ? width + ctx->font_spacing : width;
+}
+
+/** @brief Remove bytes [from, to) of the text; the caret lands at from */
+static void qui_textbox_erase(char *buffer, qui_TextboxState *state, uint32_t from, uint32_t to) {
+    memmove(buffer + from, buffer + to, (size_t)(state->length - to) + 1);
+    state->length -= to - from;
+    state->caret = state->anchor = from;
+}
+
+/** @brief Replace the selection with text, truncated to the capacity at a character boundary */
+static void qui_textbox_insert(char *buffer, size_t capacity, qui_TextboxState *state, const char *text, size_t n) {
+    if (n == 0) return;
+    if (state->caret != state->anchor) {
+        uint32_t lo = (state->caret < state->anchor) ? state->caret : state->anchor;
+        uint32_t hi = (state->caret < state->anchor) ? state->anchor : state->caret;
+        qui_textbox_erase(buffer, state, lo, hi);
+    }
+    
+    size_t room = capacity - 1 - state->length;
+    if (n > room) {
+        n = room;
+        while (n > 0 && ((unsigned char)text[n] & 0xC0) == 0x80) n--;
+    }
+    if (n == 0) return;
+    
+    /* One move of the tail per run of typed text; typing at the end moves only the terminator */
+    memmove(buffer + state->caret + n, buffer + state->caret, (size_t)(state->length - state->caret) + 1);
+    memcpy(buffer + state->caret, text, n);
+    state->length += (uint32_t)n;
+    state->caret += (uint32_t)n;
+    state->anchor = state->caret;
+}
+
+/** @brief Apply one qui_feed_key() key to the text */
+static void qui_textbox_key(char *buffer, qui_TextboxState *state, int key) {
+    bool shift = (key & QUI_KEY_SHIFT) != 0;
+    uint32_t lo = (state->caret < state->anchor) ? state->caret : state->anchor;
+    uint32_t hi = (state->caret < state->anchor) ? state->anchor : state->caret;
+    
+    switch (key & ~QUI_KEY_SHIFT) {
+        case QUI_KEY_BACKSPACE:
+            if (lo != hi) qui_textbox_erase(buffer, state, lo, hi);
+            else if (state->caret > 0) qui_textbox_erase(buffer, state, (uint32_t)qui_utf8_prev(buffer, state->caret), state->caret);
+            return;
+        case QUI_KEY_DELETE:
+            if (lo != hi) qui_textbox_erase(buffer, state, lo, hi);
+            else if (state->caret < state->length) qui_textbox_erase(buffer, state, state->caret, (uint32_t)qui_utf8_next(buffer, state->caret, state->length));
+            return;
+        case QUI_KEY_LEFT:
+            state->caret = (lo != hi && !shift) ? lo : (uint32_t)qui_utf8_prev(buffer, state->caret);
+            break;
+        case QUI_KEY_RIGHT:
+            state->caret = (lo != hi && !shift) ? hi : (uint32_t)qui_utf8_next(buffer, state->caret, state->length);
+            break;
+        case QUI_KEY_HOME:
+            state->caret = 0;
+            break;
+        case QUI_KEY_END:
+            state->caret = state->length;
+            break;
+        case QUI_KEY_SELECT_ALL:
+            state->anchor = 0;
+            state->caret = state->length;
+            return;
+        default:
+            return;
+    }
+    
+    if (!shift) state->anchor = state->caret;
+}
+
+/** @brief Byte offset under the mouse, walking only the visible characters */
+static uint32_t qui_textbox_hit(qui_Context *ctx, const char *buffer, const qui_TextboxState *state, float text_x, float inner_width) {
+    float mx = (float)ctx->mouse_pos.x - text_x;
+    float px = 0.0f;
+    size_t off = state->scroll;
+    
+    while (off < state->length && px <= inner_width) {
+        size_t next = qui_utf8_next(buffer, off, state->length);
+        float advance = qui_char_advance(ctx, buffer, state->scroll, off, next);
+        if (mx < px + advance * 0.5f) break;
+        px += advance;
+        off = next;
+    }
+    
+    return (uint32_t)off;
+}
+
+int qui_textbox(qui_Context *ctx, char *buffer, size_t capacity, float width) {
+    if (!ctx || !buffer || capacity == 0) return -1;
+    
+    qui_Id id = qui_gen_id_ptr(ctx, buffer);
+    float text_height = qui_get_text_height(ctx, "A");
+    float box_width = (width > 0.0f) ? width : 240.0f;
+    float h = text_height + 8.0f;
+    float padding = 6.0f;
+    
+    float x, y;
+    qui_layout_next(ctx, box_width, h, &x, &y);
+    
+    /* Widgets outside the clip region only advance the layout */
+    if (qui_cull_widget(ctx, id, x, y, box_width, h)) {
+        qui_layout_advance(ctx, box_width, h);
+        return (ctx->keyboard_focus_id == id) ? 1 : 0;
+    }
+    
+    qui_TextboxState *state = (qui_TextboxState*)qui_get_state(ctx, id, sizeof(qui_TextboxState));
+    if (!state) return -1;
+    
+    float text_x = x + padding;
+    float inner_width = box_width - 2.0f * padding;
+    bool pressed_inside = false;
+    
+    /* Hit testing */
+    if (qui_widget_hovered(ctx, id, x, y, box_width, h)) {
+        ctx->hot_id = id;
+        if (ctx->mouse_pressed) {
+            ctx->keyboard_focus_id = id;
+            ctx->active_id = id;
+            pressed_inside = true;
+        }
+    } else if (ctx->mouse_pressed && ctx->keyboard_focus_id == id) {
+        /* Clicked outside while focused - lose focus */
+        ctx->keyboard_focus_id = 0;
+    }
+    
+    bool focused = (ctx->keyboard_focus_id == id);
+    if (!focused) {
+        /* Unfocused boxes show the start of the text; the length is not needed */
+        state->focused = 0;
+        state->caret = state->anchor = state->scroll = 0;
+    } else {
+        /*
+         * Measure the text every frame so the application may rewrite the buffer while
+         * the box has focus. memchr() stops at the terminator, so this reads the text once,
+         * about what drawing the visible run costs anyway.
+         */
+        const char *nul = (const char*)memchr(buffer, '\0', capacity);
+        if (!nul) {
+            buffer[capacity - 1] = '\0';
+            nul = buffer + capacity - 1;
+        }
+        state->length = (uint32_t)(nul - buffer);
+        if (!state->focused) state->caret = state->anchor = state->length;
+        state->focused = 1;
+        if (state->caret > state->length) state->caret = state->length;
+        if (state->anchor > state->length) state->anchor = state->length;
+        if (state->scroll > state->caret) state->scroll = state->caret;
+        
+        /* Click places the caret, dragging extends the selection */
+        if (pressed_inside) {
+            state->caret = state->anchor = qui_textbox_hit(ctx, buffer, state, text_x, inner_width);
+        } else if (ctx->active_id == id && ctx->mouse_down) {
+            state->caret = qui_textbox_hit(ctx, buffer, state, text_x, inner_width);
+        }
+        
+        /* Typed text and keys, in the order they arrived */
+        int text_offset = 0;
+        for (int i = 0; i < ctx->key_count; i++) {
+            int until = ctx->key_text_offset[i];
+            qui_textbox_insert(buffer, capacity, state, ctx->text_input + text_offset, (size_t)(until - text_offset));
+            text_offset = until;
+            qui_textbox_key(buffer, state, ctx->keys[i]);
+        }
+        qui_textbox_insert(buffer, capacity, state, ctx->text_input + text_offset, (size_t)(ctx->text_input_length - text_offset));
+        
+        /* Keep the caret in view, measuring at most one box width of characters */
+        if (state->caret < state->scroll) {
+            state->scroll = state->caret;
+        } else {
+            float px = 0.0f;
+            size_t off = state->scroll;
+            while (off < state->caret && px <= inner_width) {
+                size_t next = qui_utf8_next(buffer, off, state->length);
+                px += qui_char_advance(ctx, buffer, state->scroll, off, next);
+                off = next;
+            }
+            if (px > inner_width) {
+                size_t first = state->caret;
+                px = 0.0f;
+                while (first > 0) {
+                    size_t prev = qui_utf8_prev(buffer, first);
+                    /* Counts the spacing before every character, so the fit errs on the short side */
+                    float advance = qui_char_advance(ctx, buffer, 0, prev, first);
+                    if (px + advance > inner_width) break;
+                    px += advance;
+                    first = prev;
+                }
+                state->scroll = (uint32_t)first;
+            }
+        }
+    }
+    
+    if (ctx->mouse_released && ctx->active_id == id) {
+        ctx->active_id = 0;
+    }
+    
+    /* Determine color based on state */
+    qui_Color32 color = focused ? ctx->colors[QUI_COLOR_ACTIVE] : qui_state_color(ctx, id);
+    
+    /* Draw textbox background */
+    qui_Rect rect = qui_rect((int)box_width, (int)h, (int)x, (int)y);
+    qui_draw_rect_safe(ctx, &rect, color);
+    
+    /* Find the visible run and the caret/selection positions in one pass */
+    uint32_t lo = (state->caret < state->anchor) ? state->caret : state->anchor;
+    uint32_t hi = (state->caret < state->anchor) ? state->anchor : state->caret;
+    float caret_x = 0.0f, sel_x0 = (lo < state->scroll) ? 0.0f : -1.0f, sel_x1 = -1.0f;
+    float px = 0.0f;
+    size_t off = state->scroll;
+    for (;;) {
+        if (off == state->caret) caret_x = px;
+        if (off == lo && sel_x0 < 0.0f) sel_x0 = px;
+        if (off == hi) sel_x1 = px;
+        if (buffer[off] == '\0' || px > inner_width) break;
+        size_t next = qui_utf8_next(buffer, off, capacity - 1);
+        if (next == off) break; /* unterminated buffer: stop at the last byte */
+        px += qui_char_advance(ctx, buffer, state->scroll, off, next);
+        off = next;
+    }
+    if (sel_x1 < 0.0f) sel_x1 = px;
+    
+    qui_push_clip(ctx, qui_rect((int)(inner_width + padding), (int)h, (int)text_x, (int)y));
+    
+    if (focused && lo != hi && sel_x0 >= 0.0f) {
+        qui_Rect sel = qui_rect((int)(sel_x1 - sel_x0), (int)text_height, (int)(text_x + sel_x0), (int)(y + 4.0f));
+        qui_draw_rect_safe(ctx, &sel, ctx->colors[QUI_COLOR_SELECTION]);
+    }
+    
+    /* Draw only the visible part of the text */
+    if (off > state->scroll) {
+        const char *visible = buffer + state->scroll;
+        if (buffer[off] != '\0') visible = qui_frame_strndup(ctx, visible, off - state->scroll);
+        if (visible) qui_draw_text_safe(ctx, visible, text_x, y + 4.0f);
+    }
+    
+    /* Draw caret if focused */
+    if (focused) {
+        qui_Rect caret = qui_rect(2, (int)text_height, (int)(text_x + caret_x), (int)(y + 4.0f));
+        qui_draw_rect_safe(ctx, &caret, ctx->colors[QUI_COLOR_TEXT]);
+    }
+    
+    qui_pop_clip(ctx);
+    
+    /* Update layout cursor */
+    qui_layout_advance(ctx, box_width, h);
+    
+    return focused ? 1 : 0;
+}
+
+int qui_image_button(qui_Context *ctx, qui_Image *image, float button_width, float button_height, float img_width, float img_height) {
+    if (!ctx || !image) return -1;
+    
+    if (image->width <= 0 || image->height <= 0 || !image->data) {
+        return -1;
+    }
+    
+    qui_Id id = qui_gen_id_ptr(ctx, image);
+    
+    /* Calculate dimensions */
+    float padding = 8.0f;
+    float w = (button_width > 0.0f) ? button_width : (float)image->width + padding * 2;
+    float h = (button_height > 0.0f) ? button_height : (float)image->height + padding * 2;
+    float img_w = (img_width > 0.0f) ? img_width : (float)image->width;
+    float img_h = (img_height > 0.0f) ? img_height : (float)image->height;
+    
+    float x, y;
+    qui_layout_next(ctx, w, h, &x, &y);
+    
+    /* Widgets outside the clip region only advance the layout */
+    if (qui_cull_widget(ctx, id, x, y, w, h)) {
+        qui_layout_advance(ctx, w, h);
+        return 0;
+    }
+    
+    /* Hit testing */
+    if (qui_widget_hovered(ctx, id, x, y, w, h)) {
+        ctx->hot_id = id;
+        if (ctx->mouse_pressed) {
+            ctx->active_id = id;
+        }
+    }
+    
+    /* Calculate centered image position */
+    float centered_x = x + (w - img_w) * 0.5f;
+    float centered_y = y + (h - img_h) * 0.5f;
+    
+    /* Draw button background and image based on state */
+    if (ctx->active_id == id) {
+        qui_Rect bg_rect = qui_rect((int)w, (int)h, (int)x, (int)y);
+        qui_draw_rect_safe(ctx, &bg_rect, ctx->colors[QUI_COLOR_ACTIVE]);
+        qui_draw_image_safe(ctx, image, centered_x + 1, centered_y + 1, img_w, img_h);
+    } else if (ctx->hot_id == id) {
+        qui_Rect bg_rect = qui_rect((int)w, (int)h, (int)x, (int)y);
+        qui_draw_rect_safe(ctx, &bg_rect, ctx->colors[QUI_COLOR_HOT]);
+        qui_draw_image_safe(ctx, image, centered_x, centered_y, img_w, img_h);
+    } else {
+        qui_draw_image_safe(ctx, image, centered_x, centered_y, img_w, img_h);
+    }
+    
+    /* Check for click */
+    int clicked = 0;
+    if (ctx->mouse_released && ctx->active_id == id) {
+        if (ctx->hover_id == id) {
+            clicked = 1;
+        }
+        ctx->active_id = 0;
+    }
+    
+    /* Update layout cursor */
+    qui_layout_advance(ctx, w, h);
+    
+    return clicked;
+}
+
+int qui_image_button_with_label(qui_Context *ctx, qui_Image *image, const char *label, float img_width, float img_height) {
+    if (!ctx || !image || !label) return -1;
+    
+    if (image->width <= 0 || image->height <= 0 || !image->data) {
+        /* Fallback to text button if image is invalid */
+        return qui_button(ctx, label);
+    }
+    
+    qui_Id id = qui_gen_id_str(ctx, label);
+    float img_w = (img_width > 0.0f) ? img_width : (float)image->width;
+    float img_h = (img_height > 0.0f) ? img_height : (float)image->height;
+    float text_width = qui_get_text_width(ctx, label);
+    float text_height = qui_get_text_height(ctx, label);
+    
+    float padding = 8.0f;
+    float spacing = 6.0f;
+    float total_width = img_w + spacing + text_width + (padding * 2);
+    float total_height = fmaxf(img_h, text_height) + (padding * 2);
+    
+    float x, y;
+    qui_layout_next(ctx, total_width, total_height, &x, &y);
+    
+    /* Widgets outside the clip region only advance the layout */
+    if (qui_cull_widget(ctx, id, x, y, total_width, total_height)) {
+        qui_layout_advance(ctx, total_width, total_height);
+        return 0;
+    }
+    
+    /* Hit testing */
+    if (qui_widget_hovered(ctx, id, x, y, total_width, total_height)) {
+        ctx->hot_id = id;
+        if (ctx->mouse_pressed) {
+            ctx->active_id = id;
+        }
+    }
+    
+    /* Determine color based on state */
+    qui_Color32 color = qui_state_color(ctx, id);
+    
+    /* Draw button background */
+    qui_Rect bg_rect = qui_rect((int)total_width, (int)total_height, (int)x, (int)y);
+    qui_draw_rect_safe(ctx, &bg_rect, color);
+    
+    /* Calculate positions */
+    float img_x = x + padding;
+    float img_y = y + (total_height - img_h) * 0.5f;
+    float text_x = img_x + img_w + spacing;
+    float text_y = y + (total_height - text_height) * 0.5f;
+    
+    /* Apply press offset for active state */
+    if (ctx->active_id == id) {
+        img_x += 1;
+        img_y += 1;
+        text_x += 1;
+        text_y += 1;
+    }
+    
+    /* Draw image and text */
+    qui_draw_image_safe(ctx, image, img_x, img_y, img_w, img_h);
+    qui_draw_text_safe(ctx, label, text_x, text_y);
+    
+    /* Check for click */
+    int clicked = 0;
+    if (ctx->mouse_released && ctx->active_id == id) {
+        if (ctx->hover_id == id) {
+            clicked = 1;
+        }
+        ctx->active_id = 0;
+    }
+    
+    /* Update layout cursor */
+    qui_layout_advance(ctx, total_width, total_height);
+    
+    return clicked;
+}
+
+int qui_image_button_vertical(qui_Context *ctx, qui_Image *image, const char *label, float img_width, float img_height) {
+    if (!ctx || !image || !label) return -1;
+    
+    if (image->width <= 0 || image->height <= 0 || !image->data) {
+        /* Fallback to text button if image is invalid */
+        return qui_button(ctx, label);
+    }
+    
+    qui_Id id = qui_gen_id_str(ctx, label);
+    float img_w = (img_width > 0.0f) ? img_width : (float)image->width;
+    float img_h = (img_height > 0.0f) ? img_height : (float)image->height;
+    float text_width = qui_get_text_width(ctx, label);
+    float text_height = qui_get_text_height(ctx, label);
+    
+    float padding = 8.0f;
+    float spacing = 4.0f;
+    float total_width = fmaxf(img_w, text_width) + (padding * 2);
+    float total_height = img_h + spacing + text_height + (padding * 2);
+    
+    float x, y;
+    qui_layout_next(ctx, total_width, total_height, &x, &y);
+    
+    /* Widgets outside the clip region only advance the layout */
+    if (qui_cull_widget(ctx, id, x, y, total_width, total_height)) {
+        qui_layout_advance(ctx, total_width, total_height);
+        return 0;
+    }
+    
+    /* Hit testing */
+    if (qui_widget_hovered(ctx, id, x, y, total_width, total_height)) {
+        ctx->hot_id = id;
+        if (ctx->mouse_pressed) {
+            ctx->active_id = id;
+        }
+    }
+    
+    /* Determine color based on state */
+    qui_Color32 color = qui_state_color(ctx, id);
+    
+    /* Draw button background */
+    qui_Rect bg_rect = qui_rect((int)total_width, (int)total_height, (int)x, (int)y);
+    qui_draw_rect_safe(ctx, &bg_rect, color);
+    
+    /* Calculate centered positions */
+    float img_x = x + (total_width - img_w) * 0.5f;
+    float img_y = y + padding;
+    float text_x = x + (total_width - text_width) * 0.5f;
+    float text_y = img_y + img_h + spacing;
+    
+    /* Apply press offset for active state */
+    if (ctx->active_id == id) {
+        img_x += 1;
+        img_y += 1;
+        text_x += 1;
+        text_y += 1;
+    }
+    
+    /* Draw image and text */
+    qui_draw_image_safe(ctx, image, img_x, img_y, img_w, img_h);
+    qui_draw_text_safe(ctx, label, text_x, text_y);
+    
+    /* Check for click */
+    int clicked = 0;
+    if (ctx->mouse_released && ctx->active_id == id) {
+        if (ctx->hover_id == id) {
+            clicked = 1;
+        }
+        ctx->active_id = 0;
+    }
+    
+    /* Update layout cursor */
+    qui_layout_advance(ctx, total_width, total_height);
+    
+    return clicked;
+}
+
+/* ================================================================================================
+ * WINDOW MANAGEMENT IMPLEMENTATION
+ * ================================================================================================ */
+
+/** @brief Persistent per-window state */
+typedef struct {
+    float drag_offset_x; /**< Mouse offset from the window origin while dragging */
+    float drag_offset_y;
+} qui_WindowState;
+
+bool qui_begin_window(qui_Context *ctx, const char *title, qui_Vec2 size, qui_Vec2 *pos) {
+    if (!ctx || !pos) return false;
+    
+    if (size.x <= 0 || size.y <= 0) return false;
+    if (ctx->id_stack_depth >= QUI_ID_STACK_SIZE) return false;
+    if (ctx->clip_depth >= QUI_CLIP_STACK_SIZE) return false;
+    if (ctx->layout_depth >= QUI_LAYOUT_STACK_SIZE) return false;
+    
+    qui_Id window_id = title ? qui_gen_id_str(ctx, title) : qui_gen_id_ptr(ctx, pos);
+    
+    /* New windows open on top */
+    int index = qui_find_window(ctx, window_id);
+    if (index < 0) {
+        if (ctx->window_count >= QUI_MAX_WINDOWS) return false;
+        index = ctx->window_count++;
+        memset(&ctx->windows[index], 0, sizeof(qui_WindowEntry));
+        ctx->windows[index].id = window_id;
+    }
+    ctx->windows[index].last_frame = ctx->frame_index;
+    
+    float x = (float)pos->x;
+    float y = (float)pos->y;
+    float w = (float)size.x;
+    float h = (float)size.y;
+    float title_height = qui_get_text_height(ctx, title ? title : "Window") + 8.0f;
+    qui_WindowState *state = (qui_WindowState*)qui_get_state(ctx, window_id, sizeof(qui_WindowState));
+    
+    /* Everything the window draws goes into its own run of commands */
+    if (!qui_push_layout(ctx)) return false;
+    qui_switch_segment(ctx, window_id);
+    QUI_TRACE_PUSH(ctx, QUI_TRACE_WINDOW, title ? title : "Window");
+    
+    /* Windows float above their parent's layout, so the parent's clip does not apply */
+    ctx->clip_stack[ctx->clip_depth++] = ctx->clip;
+    ctx->clip = QUI_CLIP_NONE;
+    
+    /* Stacking order changes what is visible even when nothing else does */
+    int32_t z = index;
+    qui_hash_value(ctx, &z, sizeof(z));
+    
+    /* Handle window dragging */
+    if ((ctx->active_id == 0 || ctx->active_id == window_id) && ctx->hover_id == window_id) {
+        bool title_bar_hit = qui_hit_test_absolute(ctx, x, y, w - 4, title_height);
+        
+        if (title_bar_hit) {
+            ctx->hot_id = window_id;
+            if (ctx->mouse_pressed && state) {
+                ctx->active_id = window_id;
+                state->drag_offset_x = (float)ctx->mouse_pos.x - x;
+                state->drag_offset_y = (float)ctx->mouse_pos.y - y;
+            }
+        }
+    }
+    
+    /* Update window position if being dragged */
+    if (ctx->active_id == window_id && ctx->mouse_down && state) {
+        pos->x = (int)((float)ctx->mouse_pos.x - state->drag_offset_x);
+        pos->y = (int)((float)ctx->mouse_pos.y - state->drag_offset_y);
+        x = (float)pos->x;
+        y = (float)pos->y;
+    }
+    
+    /* Draw window background */
+    qui_Rect window_bg = qui_rect((int)w, (int)h, (int)x, (int)y);
+    qui_draw_rect_safe(ctx, &window_bg, ctx->colors[QUI_COLOR_WINDOW_BG]);
+    
+    /* Draw title bar */
+    qui_Rect title_bar = qui_rect((int)w, (int)title_height, (int)x, (int)y);
+    qui_draw_rect_safe(ctx, &title_bar, ctx->colors[QUI_COLOR_TITLE_BAR]);
+    
+    /* Draw title text */
+    if (title) {
+        qui_draw_text_safe(ctx, title, x + 8.0f, y + 4.0f);
+    }
+    
+    /* Release drag on mouse up */
+    if (ctx->mouse_released && ctx->active_id == window_id) {
+        ctx->active_id = 0;
+    }
+    
+    /* Hover next frame is resolved against where the window ends up now */
+    qui_WindowEntry *entry = &ctx->windows[index];
+    entry->x = x;
+    entry->y = y;
+    entry->w = w;
+    entry->h = h;
+    
+    /* The window body blocks the mouse for anything behind it */
+    qui_record_hit(ctx, window_id, x, y, w, h);
+    
+    /* Set up window-relative coordinate system */
+    ctx->layout_offset_x = x + 10.0f;
+    ctx->layout_offset_y = y + title_height + 10.0f;
+    ctx->layout_start_x = 0.0f;
+    ctx->content_width = w - 20.0f;
+    ctx->cursor_x = 0.0f;
+    ctx->cursor_y = 0.0f;
+    
+    /* Widgets inside the window get IDs scoped to it */
+    ctx->id_stack[ctx->id_stack_depth++] = window_id;
+    
+    /* Clip children to the window body */
+    ctx->clip.x0 = x;
+    ctx->clip.y0 = y + title_height;
+    ctx->clip.x1 = x + w;
+    ctx->clip.y1 = y + h;
+    
+    return true;
+}
+
+qui_Result qui_end_window(qui_Context *ctx) {
+    QUI_VALIDATE_CTX(ctx);
+    
+    /* Close the window's ID scope and clip region */
+    if (ctx->id_stack_depth > 0) {
+        ctx->id_stack_depth--;
+    }
+    if (ctx->clip_depth > 0) {
+        ctx->clip = ctx->clip_stack[--ctx->clip_depth];
+    }
+    
+    /* Restore the outer layout and return to the outer window's commands */
+    if (ctx->layout_depth <= 0) {
+        return QUI_ERROR_INVALID_STATE;
+    }
+    qui_Id outer_window = ctx->layout_stack[ctx->layout_depth - 1].window;
+    qui_switch_segment(ctx, outer_window);
+    qui_pop_layout(ctx);
+    QUI_TRACE_POP(ctx);
+    
+    return QUI_OK;
+}
+
+/* ================================================================================================
+ * SCROLL REGIONS IMPLEMENTATION
+ * ================================================================================================ */
+
+/** @brief Scrollbar metrics */
+#define QUI_SCROLLBAR_WIDTH 10.0f
+#define QUI_SCROLLBAR_MIN_THUMB 16.0f
+
+/** @brief Persistent per-region scroll state */
+typedef struct {
+    float scroll_y;       /**< Distance scrolled from the top */
+    float content_height; /**< Height of the contents last frame */
+    float grab_offset;    /**< Mouse offset from the thumb top while dragging */
+} qui_ScrollState;
+
+bool qui_begin_scroll_region(qui_Context *ctx, const char *name, float width, float height) {
+    if (!ctx || !name) return false;
+    
+    if (!(width > 0.0f) || !(height > 0.0f)) return false;
+    if (ctx->scroll_depth >= QUI_SCROLL_STACK_SIZE) return false;
+    if (ctx->layout_depth >= QUI_LAYOUT_STACK_SIZE) return false;
+    if (ctx->id_stack_depth >= QUI_ID_STACK_SIZE) return false;
+    if (ctx->clip_depth >= QUI_CLIP_STACK_SIZE) return false;
+    
+    qui_Id id = qui_gen_id_str(ctx, name);
+    qui_ScrollState *state = (qui_ScrollState*)qui_get_state(ctx, id, sizeof(qui_ScrollState));
+    if (!state) return false;
+    
+    float x, y;
+    qui_layout_next(ctx, width, height, &x, &y);
+    x += ctx->layout_offset_x;
+    y += ctx->layout_offset_y;
+    float max_scroll = fmaxf(0.0f, state->content_height - height);
+    if (state->scroll_y > max_scroll) state->scroll_y = max_scroll;
+    if (state->scroll_y < 0.0f) state->scroll_y = 0.0f;
+    
+    /* Scrollbar, sized from last frame's content height */
+    float content_width = width;
+    if (max_scroll > 0.0f) {
+        qui_Id bar_id = qui_fnv1a32(id, "#scrollbar", 10);
+        float track_x = x + width - QUI_SCROLLBAR_WIDTH;
+        float thumb_h = fmaxf(QUI_SCROLLBAR_MIN_THUMB, height * height / state->content_height);
+        if (thumb_h > height) thumb_h = height;
+        float travel = height - thumb_h;
+        float thumb_y = y + travel * (state->scroll_y / max_scroll);
+        content_width -= QUI_SCROLLBAR_WIDTH;
+        
+        if (qui_widget_hovered(ctx, bar_id, track_x - ctx->layout_offset_x, y - ctx->layout_offset_y, QUI_SCROLLBAR_WIDTH, height)) {
+            ctx->hot_id = bar_id;
+            if (ctx->mouse_pressed) {
+                ctx->active_id = bar_id;
+                float my = (float)ctx->mouse_pos.y;
+                /* Clicking the track jumps the thumb centre to the mouse */
+                state->grab_offset = (my >= thumb_y && my < thumb_y + thumb_h) ? my - thumb_y : thumb_h * 0.5f;
+            }
+        }
+        
+        if (ctx->active_id == bar_id) {
+            if (ctx->mouse_down && travel > 0.0f) {
+                float t = ((float)ctx->mouse_pos.y - state->grab_offset - y) / travel;
+                if (t < 0.0f) t = 0.0f;
+                if (t > 1.0f) t = 1.0f;
+                state->scroll_y = t * max_scroll;
+                thumb_y = y + travel * t;
+            }
+            if (ctx->mouse_released) {
+                ctx->active_id = 0;
+            }
+        }
+        
+        qui_Color32 thumb_color = ctx->colors[QUI_COLOR_HOT];
+        if (ctx->active_id == bar_id) {
+            thumb_color = ctx->colors[QUI_COLOR_ACTIVE];
+        }
+        qui_Rect track = qui_rect((int)QUI_SCROLLBAR_WIDTH, (int)height,
+                                  (int)(track_x - ctx->layout_offset_x), (int)(y - ctx->layout_offset_y));
+        qui_draw_rect_safe(ctx, &track, ctx->colors[QUI_COLOR_FOREGROUND]);
+        qui_Rect thumb = qui_rect((int)QUI_SCROLLBAR_WIDTH, (int)thumb_h,
+                                  (int)(track_x - ctx->layout_offset_x), (int)(thumb_y - ctx->layout_offset_y));
+        qui_draw_rect_safe(ctx, &thumb, thumb_color);
+    }
+    
+    qui_ScrollFrame *frame = &ctx->scroll_stack[ctx->scroll_depth++];
+    frame->id = id;
+    frame->state = state;
+    frame->x = x;
+    frame->y = y;
+    frame->w = width;
+    frame->h = height;
+    qui_push_layout(ctx);
+    
+    /* Contents are laid out from the scrolled origin and clipped to the region */
+    qui_ClipRect body = {x, y, x + content_width, y + height};
+    qui_push_clip_absolute(ctx, &body);
+    ctx->id_stack[ctx->id_stack_depth++] = id;
+    ctx->layout_offset_x = x;
+    ctx->layout_offset_y = y - state->scroll_y;
+    ctx->layout_start_x = 0.0f;
+    ctx->content_width = content_width;
+    ctx->cursor_x = 0.0f;
+    ctx->cursor_y = 0.0f;
+    
+    return true;
+}
+
+qui_Result qui_end_scroll_region(qui_Context *ctx) {
+    QUI_VALIDATE_CTX(ctx);
+    
+    if (ctx->scroll_depth <= 0) {
+        return QUI_ERROR_INVALID_STATE;
+    }
+    
+    qui_ScrollFrame *frame = &ctx->scroll_stack[--ctx->scroll_depth];
+    qui_ScrollState *state = (qui_ScrollState*)frame->state;
+    state->content_height = ctx->cursor_y;
+    
+    if (ctx->id_stack_depth > 0) {
+        ctx->id_stack_depth--;
+    }
+    if (ctx->clip_depth > 0) {
+        ctx->clip = ctx->clip_stack[--ctx->clip_depth];
+    }
+    qui_pop_layout(ctx);
+    
+    /* Inner regions end first, so the innermost region under the mouse takes the wheel */
+    if (ctx->mouse_wheel != 0.0f &&
+        qui_hit_test(ctx, frame->x - ctx->layout_offset_x, frame->y - ctx->layout_offset_y, frame->w, frame->h)) {
+        float max_scroll = fmaxf(0.0f, state->content_height - frame->h);
+        float scroll = state->scroll_y - ctx->mouse_wheel * QUI_SCROLL_STEP;
+        if (scroll > max_scroll) scroll = max_scroll;
+        if (scroll < 0.0f) scroll = 0.0f;
+        if (scroll != state->scroll_y) {
+            state->scroll_y = scroll;
+            ctx->redraw_requested = true;
+        }
+        ctx->mouse_wheel = 0.0f;
+    }
+    
+    qui_layout_advance(ctx, frame->w, frame->h);
+    
+    return QUI_OK;
+}
+
+/** @brief Visible span of the current clip in layout Y coordinates */
+static void qui_visible_span(const qui_Context *ctx, float *top, float *bottom) {
+    if (ctx->clip_depth == 0) {
+        *top = -1e30f;
+        *bottom = 1e30f;
+        return;
+    }
+    *top = ctx->clip.y0 - ctx->layout_offset_y;
+    *bottom = ctx->clip.y1 - ctx->layout_offset_y;
+}
+
+qui_Result qui_list_clipper_begin(qui_Context *ctx, qui_ListClipper *clipper, int item_count, float item_height) {
+    QUI_VALIDATE_CTX(ctx);
+    QUI_VALIDATE_PTR(clipper);
+    
+    if (item_count < 0 || !(item_height > 0.0f) || !isfinite(item_height)) {
+        return QUI_ERROR_INVALID_VALUE;
+    }
+    
+    float top, bottom;
+    qui_visible_span(ctx, &top, &bottom);
+    
+    clipper->item_count = item_count;
+    clipper->item_height = item_height;
+    clipper->offsets = NULL;
+    clipper->start_y = ctx->cursor_y;
+    
+    double first = floor(((double)top - clipper->start_y) / item_height);
+    double last = ceil(((double)bottom - clipper->start_y) / item_height);
+    clipper->display_start = (first <= 0.0) ? 0 : (first >= item_count) ? item_count : (int)first;
+    clipper->display_end = (last <= 0.0) ? 0 : (last >= item_count) ? item_count : (int)last;
+    if (clipper->display_end < clipper->display_start) clipper->display_end = clipper->display_start;
+    
+    ctx->cursor_y = clipper->start_y + (float)clipper->display_start * item_height;
+    return QUI_OK;
+}
+
+/** @brief Index of the first row that ends after y (offsets must be non-decreasing) */
+static int qui_offsets_search(const float *offsets, int count, float y) {
+    int lo = 0;
+    int hi = count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (offsets[mid + 1] <= y) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+qui_Result qui_list_clipper_begin_offsets(qui_Context *ctx, qui_ListClipper *clipper, int item_count, const float *offsets) {
+    QUI_VALIDATE_CTX(ctx);
+    QUI_VALIDATE_PTR(clipper);
+    QUI_VALIDATE_PTR(offsets);
+    
+    if (item_count < 0) {
+        return QUI_ERROR_INVALID_VALUE;
+    }
+    
+    float top, bottom;
+    qui_visible_span(ctx, &top, &bottom);
+    
+    clipper->item_count = item_count;
+    clipper->item_height = 0.0f;
+    clipper->offsets = offsets;
+    clipper->start_y = ctx->cursor_y;
+    clipper->display_start = qui_offsets_search(offsets, item_count, top - clipper->start_y);
+    clipper->display_end = qui_offsets_search(offsets, item_count, bottom - clipper->start_y);
+    if (clipper->display_end < item_count && offsets[clipper->display_end] < bottom - clipper->start_y) {
+        clipper->display_end++;
+    }
+    if (clipper->display_end < clipper->display_start) clipper->display_end = clipper->display_start;
+    
+    ctx->cursor_y = clipper->start_y + offsets[clipper->display_start];
+    return QUI_OK;
+}
+
+qui_Result qui_list_clipper_end(qui_Context *ctx, qui_ListClipper *clipper) {
+    QUI_VALIDATE_CTX(ctx);
+    QUI_VALIDATE_PTR(clipper);
+    
+    float total = clipper->offsets ? clipper->offsets[clipper->item_count]
+                                   : (float)clipper->item_count * clipper->item_height;
+    ctx->cursor_y = clipper->start_y + total;
+    ctx->cursor_x = ctx->layout_start_x;
+    
+    return QUI_OK;
+}
+
+/* ================================================================================================
+ * LAYOUT IMPLEMENTATION
+ * ================================================================================================ */
+
+/** @brief Per-row measurements kept in the state store between frames */
+typedef struct {
+    float auto_width[QUI_LAYOUT_MAX_COLUMNS]; /**< Widest widget per column last frame */
+    float height;                             /**< Tallest row last frame */
+} qui_RowState;
+
+qui_Size qui_size_auto(void) {
+    qui_Size size = { QUI_SIZE_AUTO, 0.0f };
+    return size;
+}
+
+qui_Size qui_size_fixed(float pixels) {
+    qui_Size size = { QUI_SIZE_FIXED, pixels };
+    return size;
+}
+
+qui_Size qui_size_percent(float percent) {
+    qui_Size size = { QUI_SIZE_PERCENT, percent };
+    return size;
+}
+
+qui_Size qui_size_flex(float weight) {
+    qui_Size size = { QUI_SIZE_FLEX, weight };
+    return size;
+}
+
+qui_Result qui_layout_row(qui_Context *ctx, int columns, const qui_Size *sizes, float width) {
+    QUI_VALIDATE_CTX(ctx);
+    
+    if (columns < 1 || columns > QUI_LAYOUT_MAX_COLUMNS) return QUI_ERROR_INVALID_VALUE;
+    if (ctx->row.active) return QUI_ERROR_INVALID_STATE;
+    if (width <= 0.0f) width = ctx->content_width;
+    if (width <= 0.0f) return QUI_ERROR_INVALID_VALUE;
+    
+    qui_RowLayout *row = &ctx->row;
+    uint32_t serial = ctx->layout_serial++;
+    row->id = qui_hash_id(ctx, &serial, sizeof(serial));
+    const qui_RowState *cached = (const qui_RowState*)qui_get_state(ctx, row->id, sizeof(qui_RowState));
+    
+    /* Fixed, percent and auto columns first; flex columns share what is left */
+    float available = width - ctx->spacing_x * (float)(columns - 1);
+    float used = 0.0f;
+    float weights = 0.0f;
+    for (int i = 0; i < columns; i++) {
+        qui_Size size = sizes ? sizes[i] : qui_size_flex(1.0f);
+        float w = 0.0f;
+        switch (size.mode) {
+            case QUI_SIZE_FIXED:   w = size.value; break;
+            case QUI_SIZE_PERCENT: w = available * size.value / 100.0f; break;
+            case QUI_SIZE_AUTO:    w = cached ? cached->auto_width[i] : 0.0f; break;
+            case QUI_SIZE_FLEX:    weights += (size.value > 0.0f) ? size.value : 0.0f; break;
+        }
+        if (w < 0.0f) w = 0.0f;
+        row->sizes[i] = size;
+        row->widths[i] = w;
+        row->measured[i] = 0.0f;
+        used += w;
+    }
+    
+    float remaining = available - used;
+    if (remaining < 0.0f) remaining = 0.0f;
+    for (int i = 0; i < columns; i++) {
+        if (row->sizes[i].mode == QUI_SIZE_FLEX && weights > 0.0f && row->sizes[i].value > 0.0f) {
+            row->widths[i] = remaining * row->sizes[i].value / weights;
+        }
+    }
+    
+    row->active = true;
+    row->columns = columns;
+    row->column = 0;
+    row->x = ctx->cursor_x;
+    row->y = ctx->cursor_y;
+    row->cell_x = row->x;
+    row->row_height = 0.0f;
+    row->measured_height = 0.0f;
+    row->cached_height = cached ? cached->height : 0.0f;
+    row->align_x = QUI_ALIGN_START;
+    row->align_y = QUI_ALIGN_START;
+    
+    return QUI_OK;
+}
+
+qui_Result qui_layout_align(qui_Context *ctx, qui_Align horizontal, qui_Align vertical) {
+    QUI_VALIDATE_CTX(ctx);
+    
+    if (!ctx->row.active) return QUI_ERROR_INVALID_STATE;
+    
+    ctx->row.align_x = horizontal;
+    ctx->row.align_y = vertical;
+    
+    return QUI_OK;
+}
+
+qui_Result qui_layout_end(qui_Context *ctx) {
+    QUI_VALIDATE_CTX(ctx);
+    
+    qui_RowLayout *row = &ctx->row;
+    if (!row->active) return QUI_ERROR_INVALID_STATE;
+    
+    if (row->column > 0) {
+        qui_layout_wrap(ctx);
+    }
+    
+    /* Keep this frame's measurements; auto columns that changed size need another frame */
+    qui_RowState *cached = (qui_RowState*)qui_get_state(ctx, row->id, sizeof(qui_RowState));
+    if (cached) {
+        bool changed = cached->height != row->measured_height;
+        for (int i = 0; i < row->columns; i++) {
+            if (row->sizes[i].mode == QUI_SIZE_AUTO && cached->auto_width[i] != row->measured[i]) {
+                changed = true;
+            }
+        }
+        if (changed) {
+            memcpy(cached->auto_width, row->measured, sizeof(float) * (size_t)row->columns);
+            cached->height = row->measured_height;
+            ctx->redraw_requested = true;
+        }
+    }
+    
+    row->active = false;
+    ctx->cursor_x = ctx->layout_start_x;
+    ctx->cursor_y = row->y;
+    
+    return QUI_OK;
+}
+
+/* ================================================================================================
+ * TEXT DOCUMENTS IMPLEMENTATION
+ * ================================================================================================ */
+
+/** @brief Index of the first entry >= value in a sorted array */
+static size_t qui_lower_bound(const size_t *values, size_t count, size_t value) {
+    size_t lo = 0;
+    size_t hi = count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (values[mid] < value) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+/** @brief '\n' bytes in [start, start + length) of the original or added text */
+static size_t qui_textdoc_count_lines(const qui_TextDoc *doc, int added, size_t start, size_t length) {
+    const size_t *lines = added ? doc->added_lines : doc->original_lines;
+    size_t count = added ? doc->added_line_count : doc->original_line_count;
+    return qui_lower_bound(lines, count, start + length) - qui_lower_bound(lines, count, start);
+}
+
+/** @brief Text of a piece */
+static const char* qui_textdoc_piece_text(const qui_TextDoc *doc, const qui_TextPiece *piece) {
+    return (piece->added ? doc->added : doc->original) + piece->start;
+}
+
+/** @brief Piece containing pos; *piece_start receives its document offset (piece_count at the end) */
+static int qui_textdoc_find(const qui_TextDoc *doc, size_t pos, size_t *piece_start) {
+    size_t offset = 0;
+    for (int i = 0; i < doc->piece_count; i++) {
+        if (pos < offset + doc->pieces[i].length) {
+            *piece_start = offset;
+            return i;
+        }
+        offset += doc->pieces[i].length;
+    }
+    *piece_start = offset;
+    return doc->piece_count;
+}
+
+/** @brief Make room for extra pieces */
+static bool qui_textdoc_reserve(qui_TextDoc *doc, int extra) {
+    if (doc->piece_count + extra <= doc->piece_capacity) return true;
+    
+    int capacity = doc->piece_capacity ? doc->piece_capacity * 2 : 16;
+    while (capacity < doc->piece_count + extra) capacity *= 2;
+    qui_TextPiece *pieces = (qui_TextPiece*)QUI_REALLOC(doc->pieces, sizeof(qui_TextPiece) * (size_t)capacity);
+    if (!pieces) return false;
+    
+    doc->pieces = pieces;
+    doc->piece_capacity = capacity;
+    return true;
+}
+
+qui_Result qui_textdoc_init(qui_TextDoc *doc, const char *text, size_t length) {
+    QUI_VALIDATE_PTR(doc);
+    
+    if (!text && length > 0) {
+        return QUI_ERROR_NULL_POINTER;
+    }
+    
+    memset(doc, 0, sizeof(*doc));
+    doc->original = text;
+    doc->original_length = length;
+    
+    /* Count, then record, the line breaks of the original text */
+    size_t count = 0;
+    for (const char *p = text, *end = text + length; p && p < end; p++) {
+        p = (const char*)memchr(p, '\n', (size_t)(end - p));
+        if (!p) break;
+        count++;
+    }
+    if (count > 0) {
+        doc->original_lines = (size_t*)QUI_MALLOC(sizeof(size_t) * count);
+        if (!doc->original_lines) {
+            return QUI_ERROR_OUT_OF_MEMORY;
+        }
+        for (const char *p = text, *end = text + length; p < end; p++) {
+            p = (const char*)memchr(p, '\n', (size_t)(end - p));
+            if (!p) break;
+            doc->original_lines[doc->original_line_count++] = (size_t)(p - text);
+        }
+    }
+    
+    if (length > 0) {
+        if (!qui_textdoc_reserve(doc, 1)) {
+            qui_textdoc_free(doc);
+            return QUI_ERROR_OUT_OF_MEMORY;
+        }
+        qui_TextPiece piece = { 0, length, count, 0 };
+        doc->pieces[doc->piece_count++] = piece;
+    }
+    doc->length = length;
+    doc->line_count = count + 1;
+    
+    return QUI_OK;
+}
+
+qui_Result qui_textdoc_free(qui_TextDoc *doc) {
+    QUI_VALIDATE_PTR(doc);
+    
+    QUI_FREE(doc->original_lines);
+    QUI_FREE(doc->added);
+    QUI_FREE(doc->added_lines);
+    QUI_FREE(doc->pieces);
+    memset(doc, 0, sizeof(*doc));
+    
+    return QUI_OK;
+}
+
+qui_Result qui_textdoc_insert(qui_TextDoc *doc, size_t pos, const char *text, size_t length) {
+    QUI_VALIDATE_PTR(doc);
+    QUI_VALIDATE_PTR(text);
+    
+    if (pos > doc->length) {
+        return QUI_ERROR_INVALID_VALUE;
+    }
+    if (length == 0) {
+        return QUI_OK;
+    }
+    
+    /* Reserve everything first so a failed allocation leaves the document unchanged */
+    size_t newlines = 0;
+    for (size_t i = 0; i < length; i++) {
+        if (text[i] == '\n') newlines++;
+    }
+    if (!qui_textdoc_reserve(doc, 2)) {
+        return QUI_ERROR_OUT_OF_MEMORY;
+    }
+    if (doc->added_length + length > doc->added_capacity) {
+        size_t capacity = doc->added_capacity ? doc->added_capacity * 2 : 256;
+        while (capacity < doc->added_length + length) capacity *= 2;
+        char *added = (char*)QUI_REALLOC(doc->added, capacity);
+        if (!added) return QUI_ERROR_OUT_OF_MEMORY;
+        doc->added = added;
+        doc->added_capacity = capacity;
+    }
+    if (doc->added_line_count + newlines > doc->added_line_capacity) {
+        size_t capacity = doc->added_line_capacity ? doc->added_line_capacity * 2 : 64;
+        while (capacity < doc->added_line_count + newlines) capacity *= 2;
+        size_t *lines = (size_t*)QUI_REALLOC(doc->added_lines, sizeof(size_t) * capacity);
+        if (!lines) return QUI_ERROR_OUT_OF_MEMORY;
+        doc->added_lines = lines;
+        doc->added_line_capacity = capacity;
+    }
+    
+    size_t start = doc->added_length;
+    memcpy(doc->added + start, text, length);
+    for (size_t i = 0; i < length; i++) {
+        if (text[i] == '\n') doc->added_lines[doc->added_line_count++] = start + i;
+    }
+    doc->added_length += length;
+    
+    size_t piece_start;
+    int i = qui_textdoc_find(doc, pos, &piece_start);
+    qui_TextPiece piece = { start, length, newlines, 1 };
+    
+    if (i > 0 && piece_start == pos && doc->pieces[i - 1].added &&
+        doc->pieces[i - 1].start + doc->pieces[i - 1].length == start) {
+        /* Continues the previous insertion: grow its piece */
+        doc->pieces[i - 1].length += length;
+        doc->pieces[i - 1].newlines += newlines;
+    } else if (i < doc->piece_count && pos > piece_start) {
+        /* Lands inside a piece: split it around the new one */
+        qui_TextPiece left = doc->pieces[i];
+        qui_TextPiece right = left;
+        left.length = pos - piece_start;
+        left.newlines = qui_textdoc_count_lines(doc, left.added, left.start, left.length);
+        right.start += left.length;
+        right.length -= left.length;
+        right.newlines -= left.newlines;
+        memmove(doc->pieces + i + 3, doc->pieces + i + 1, sizeof(qui_TextPiece) * (size_t)(doc->piece_count - i - 1));
+        doc->pieces[i] = left;
+        doc->pieces[i + 1] = piece;
+        doc->pieces[i + 2] = right;
+        doc->piece_count += 2;
+    } else {
+        memmove(doc->pieces + i + 1, doc->pieces + i, sizeof(qui_TextPiece) * (size_t)(doc->piece_count - i));
+        doc->pieces[i] = piece;
+        doc->piece_count++;
+    }
+    
+    doc->length += length;
+    doc->line_count += newlines;
+    
+    return QUI_OK;
+}
+
+qui_Result qui_textdoc_erase(qui_TextDoc *doc, size_t pos, size_t length) {
+    QUI_VALIDATE_PTR(doc);
+    
+    if (pos > doc->length) {
+        return QUI_ERROR_INVALID_VALUE;
+    }
+    if (length > doc->length - pos) length = doc->length - pos;
+    if (length == 0) {
+        return QUI_OK;
+    }
+    
+    size_t end = pos + length;
+    size_t piece_start;
+    int i = qui_textdoc_find(doc, pos, &piece_start);
+    size_t removed_lines = 0;
+    
+    if (pos > piece_start && end < piece_start + doc->pieces[i].length) {
+        /* Inside one piece: keep both ends */
+        if (!qui_textdoc_reserve(doc, 1)) {
+            return QUI_ERROR_OUT_OF_MEMORY;
+        }
+        qui_TextPiece left = doc->pieces[i];
+        qui_TextPiece right = left;
+        left.length = pos - piece_start;
+        left.newlines = qui_textdoc_count_lines(doc, left.added, left.start, left.length);
+        right.start += end - piece_start;
+        right.length -= end - piece_start;
+        right.newlines = qui_textdoc_count_lines(doc, right.added, right.start, right.length);
+        removed_lines = doc->pieces[i].newlines - left.newlines - right.newlines;
+        memmove(doc->pieces + i + 2, doc->pieces + i + 1, sizeof(qui_TextPiece) * (size_t)(doc->piece_count - i - 1));
+        doc->pieces[i] = left;
+        doc->pieces[i + 1] = right;
+        doc->piece_count++;
+    } else {
+        /* Trim the pieces the range touches, then drop the empty ones */
+        int first = i;
+        for (; i < doc->piece_count && piece_start < end; i++) {
+            qui_TextPiece *piece = &doc->pieces[i];
+            size_t piece_end = piece_start + piece->length;
+            size_t cut_lo = ((pos > piece_start) ? pos : piece_start) - piece_start;
+            size_t cut_hi = ((end < piece_end) ? end : piece_end) - piece_start;
+            size_t old_lines = piece->newlines;
+            
+            if (cut_lo == 0) {
+                piece->start += cut_hi;
+                piece->length -= cut_hi;
+            } else {
+                piece->length = cut_lo;
+            }
+            piece->newlines = qui_textdoc_count_lines(doc, piece->added, piece->start, piece->length);
+            removed_lines += old_lines - piece->newlines;
+            piece_start = piece_end;
+        }
+        
+        int kept = first;
+        for (int k = first; k < i; k++) {
+            if (doc->pieces[k].length > 0) doc->pieces[kept++] = doc->pieces[k];
+        }
+        memmove(doc->pieces + kept, doc->pieces + i, sizeof(qui_TextPiece) * (size_t)(doc->piece_count - i));
+        doc->piece_count -= i - kept;
+    }
+    
+    doc->length -= length;
+    doc->line_count -= removed_lines;
+    
+    return QUI_OK;
+}
+
+size_t qui_textdoc_copy(const qui_TextDoc *doc, size_t pos, char *out, size_t length) {
+    if (!doc || !out || pos >= doc->length) return 0;
+    
+    size_t piece_start;
+    size_t copied = 0;
+    for (int i = qui_textdoc_find(doc, pos, &piece_start); i < doc->piece_count && copied < length; i++) {
+        const qui_TextPiece *piece = &doc->pieces[i];
+        size_t skip = pos + copied - piece_start;
+        size_t n = piece->length - skip;
+        if (n > length - copied) n = length - copied;
+        memcpy(out + copied, qui_textdoc_piece_text(doc, piece) + skip, n);
+        copied += n;
+        piece_start += piece->length;
+    }
+    
+    return copied;
+}
+
+size_t qui_textdoc_line_start(const qui_TextDoc *doc, size_t line) {
+    if (!doc || line == 0) return 0;
+    if (line >= doc->line_count) return doc->length;
+    
+    /* Find the piece holding the line-th '\n', then binary search its buffer's index */
+    size_t offset = 0;
+    size_t seen = 0;
+    for (int i = 0; i < doc->piece_count; i++) {
+        const qui_TextPiece *piece = &doc->pieces[i];
+        if (seen + piece->newlines >= line) {
+            const size_t *lines = piece->added ? doc->added_lines : doc->original_lines;
+            size_t count = piece->added ? doc->added_line_count : doc->original_line_count;
+            size_t index = qui_lower_bound(lines, count, piece->start) + (line - seen) - 1;
+            return offset + (lines[index] - piece->start) + 1;
+        }
+        seen += piece->newlines;
+        offset += piece->length;
+    }
+    
+    return doc->length;
+}
+
+size_t qui_textdoc_line_of(const qui_TextDoc *doc, size_t pos) {
+    if (!doc) return 0;
+    if (pos >= doc->length) return doc->line_count - 1;
+    
+    size_t offset = 0;
+    size_t seen = 0;
+    for (int i = 0; i < doc->piece_count; i++) {
+        const qui_TextPiece *piece = &doc->pieces[i];
+        if (pos < offset + piece->length) {
+            return seen + qui_textdoc_count_lines(doc, piece->added, piece->start, pos - offset);
+        }
+        seen += piece->newlines;
+        offset += piece->length;
+    }
+    
+    return doc->line_count - 1;
+}
+
+/** @brief Offset of the '\n' ending a line, or the document length for the last line */
+static size_t qui_textdoc_line_end(const qui_TextDoc *doc, size_t line) {
+    return (line + 1 < doc->line_count) ? qui_textdoc_line_start(doc, line + 1) - 1 : doc->length;
+}
+
+/** @brief Persistent per-editor caret and selection */
+typedef struct {
+    size_t caret;      /**< Caret byte offset */
+    size_t anchor;     /**< Selection anchor byte offset (== caret when nothing is selected) */
+    float preferred_x; /**< Column kept while moving up and down (< 0 = take it from the caret) */
+    int focused;       /**< Had keyboard focus last frame */
+} qui_EditorState;
+
+/** @brief Line text copied into out (cut to QUI_EDITOR_LINE_BYTES and NUL-terminated) */
+static size_t qui_editor_line_text(const qui_TextDoc *doc, size_t start, size_t end, char *out) {
+    size_t n = end - start;
+    if (n > QUI_EDITOR_LINE_BYTES) n = QUI_EDITOR_LINE_BYTES;
+    n = qui_textdoc_copy(doc, start, out, n);
+    out[n] = '\0';
+    return n;
+}
+
+/** @brief Width of the first n bytes of a line */
+static float qui_editor_advance(qui_Context *ctx, const char *text, size_t n) {
+    float x = 0.0f;
+    for (size_t off = 0; off < n; ) {
+        size_t next = qui_utf8_next(text, off, n);
+        x += qui_char_advance(ctx, text, 0, off, next);
+        off = next;
+    }
+    return x;
+}
+
+/** @brief Horizontal position of a document offset within its line */
+static float qui_editor_x_of(qui_Context *ctx, const qui_TextDoc *doc, size_t pos) {
+    char text[QUI_EDITOR_LINE_BYTES + 1];
+    size_t start = qui_textdoc_line_start(doc, qui_textdoc_line_of(doc, pos));
+    size_t n = qui_editor_line_text(doc, start, pos, text);
+    return qui_editor_advance(ctx, text, n);
+}
+
+/** @brief Document offset nearest to x on a line */
+static size_t qui_editor_pos_at(qui_Context *ctx, const qui_TextDoc *doc, size_t line, float x) {
+    char text[QUI_EDITOR_LINE_BYTES + 1];
+    size_t start = qui_textdoc_line_start(doc, line);
+    size_t n = qui_editor_line_text(doc, start, qui_textdoc_line_end(doc, line), text);
+    float px = 0.0f;
+    size_t off = 0;
+    
+    while (off < n) {
+        size_t next = qui_utf8_next(text, off, n);
+        float advance = qui_char_advance(ctx, text, 0, off, next);
+        if (x < px + advance * 0.5f) break;
+        px += advance;
+        off = next;
+    }
+    
+    return start + off;
+}
+
+/** @brief Offset of the character before pos */
+static size_t qui_editor_prev(const qui_TextDoc *doc, size_t pos) {
+    char c;
+    while (pos > 0) {
+        pos--;
+        if (qui_textdoc_copy(doc, pos, &c, 1) == 1 && ((unsigned char)c & 0xC0) != 0x80) break;
+    }
+    return pos;
+}
+
+/** @brief Offset of the character after pos */
+static size_t qui_editor_next(const qui_TextDoc *doc, size_t pos) {
+    char c;
+    while (pos < doc->length) {
+        pos++;
+        if (qui_textdoc_copy(doc, pos, &c, 1) == 1 && ((unsigned char)c & 0xC0) != 0x80) break;
+    }
+    return pos;
+}
+
+/** @brief Replace the selection with text */
+static void qui_editor_replace(qui_TextDoc *doc, qui_EditorState *state, const char *text, size_t n) {
+    size_t lo = (state->caret < state->anchor) ? state->caret : state->anchor;
+    size_t hi = (state->caret < state->anchor) ? state->anchor : state->caret;
+    
+    qui_textdoc_erase(doc, lo, hi - lo);
+    state->caret = lo;
+    if (n > 0 && qui_textdoc_insert(doc, lo, text, n) == QUI_OK) {
+        state->caret += n;
+    }
+    state->anchor = state->caret;
+    state->preferred_x = -1.0f;
+}
+
+/** @brief Apply one qui_feed_key() key to the document */
+static void qui_editor_key(qui_Context *ctx, qui_TextDoc *doc, qui_EditorState *state, int key, int page_lines) {
+    bool shift = (key & QUI_KEY_SHIFT) != 0;
+    size_t lo = (state->caret < state->anchor) ? state->caret : state->anchor;
+    size_t hi = (state->caret < state->anchor) ? state->anchor : state->caret;
+    int lines = 0;
+    
+    switch (key & ~QUI_KEY_SHIFT) {
+        case QUI_KEY_ENTER:
+            qui_editor_replace(doc, state, "\n", 1);
+            return;
+        case QUI_KEY_BACKSPACE:
+            if (lo == hi) state->anchor = qui_editor_prev(doc, state->caret);
+            qui_editor_replace(doc, state, NULL, 0);
+            return;
+        case QUI_KEY_DELETE:
+            if (lo == hi) state->anchor = qui_editor_next(doc, state->caret);
+            qui_editor_replace(doc, state, NULL, 0);
+            return;
+        case QUI_KEY_LEFT:
+            state->caret = (lo != hi && !shift) ? lo : qui_editor_prev(doc, state->caret);
+            break;
+        case QUI_KEY_RIGHT:
+            state->caret = (lo != hi && !shift) ? hi : qui_editor_next(doc, state->caret);
+            break;
+        case QUI_KEY_HOME:
+            state->caret = qui_textdoc_line_start(doc, qui_textdoc_line_of(doc, state->caret));
+            break;
+        case QUI_KEY_END:
+            state->caret = qui_textdoc_line_end(doc, qui_textdoc_line_of(doc, state->caret));
+            break;
+        case QUI_KEY_SELECT_ALL:
+            state->anchor = 0;
+            state->caret = doc->length;
+            state->preferred_x = -1.0f;
+            return;
+        case QUI_KEY_UP:        lines = -1; break;
+        case QUI_KEY_DOWN:      lines = 1; break;
+        case QUI_KEY_PAGE_UP:   lines = -page_lines; break;
+        case QUI_KEY_PAGE_DOWN: lines = page_lines; break;
+        default:
+            return;
+    }
+    
+    if (lines != 0) {
+        /* Vertical moves keep the column the caret had before the first of them */
+        if (state->preferred_x < 0.0f) state->preferred_x = qui_editor_x_of(ctx, doc, state->caret);
+        size_t line = qui_textdoc_line_of(doc, state->caret);
+        size_t target = (lines < 0) ? ((line > (size_t)-lines) ? line - (size_t)-lines : 0)
+                                    : line + (size_t)lines;
+        if (target >= doc->line_count) target = doc->line_count - 1;
+        state->caret = qui_editor_pos_at(ctx, doc, target, state->preferred_x);
+    } else {
+        state->preferred_x = -1.0f;
+    }
+    
+    if (!shift) state->anchor = state->caret;
+}
+
+int qui_text_editor(qui_Context *ctx, const char *name, qui_TextDoc *doc, float width, float height) {
+    if (!ctx || !name || !doc) return -1;
+    
+    float line_height = qui_get_text_height(ctx, "A") + 4.0f;
+    float padding = 4.0f;
+    
+    if (!qui_begin_scroll_region(ctx, name, width, height)) return -1;
+    
+    qui_ScrollFrame *frame = &ctx->scroll_stack[ctx->scroll_depth - 1];
+    qui_ScrollState *scroll = (qui_ScrollState*)frame->state;
+    qui_Id id = qui_fnv1a32(frame->id, "#editor", 7);
+    qui_EditorState *state = (qui_EditorState*)qui_get_state(ctx, id, sizeof(qui_EditorState));
+    if (!state) {
+        qui_end_scroll_region(ctx);
+        return -1;
+    }
+    
+    float view_width = ctx->content_width;
+    float view_top = scroll->scroll_y;
+    bool pressed_inside = false;
+    
+    /* Hit testing over the visible part of the region */
+    if (qui_widget_hovered(ctx, id, 0.0f, view_top, view_width, height)) {
+        ctx->hot_id = id;
+        if (ctx->mouse_pressed) {
+            ctx->keyboard_focus_id = id;
+            ctx->active_id = id;
+            pressed_inside = true;
+        }
+    } else if (ctx->mouse_pressed && ctx->keyboard_focus_id == id) {
+        ctx->keyboard_focus_id = 0;
+    }
+    
+    bool focused = (ctx->keyboard_focus_id == id);
+    if (state->caret > doc->length) state->caret = doc->length;
+    if (state->anchor > doc->length) state->anchor = doc->length;
+    if (!state->focused) state->preferred_x = -1.0f;
+    state->focused = focused;
+    
+    if (focused) {
+        size_t old_caret = state->caret;
+        size_t old_length = doc->length;
+        
+        /* Click places the caret, dragging extends the selection */
+        if (pressed_inside || (ctx->active_id == id && ctx->mouse_down)) {
+            float local_y = (float)ctx->mouse_pos.y - ctx->layout_offset_y;
+            float line = floorf(local_y / line_height);
+            size_t target = (line <= 0.0f) ? 0 : (line >= (float)doc->line_count) ? doc->line_count - 1 : (size_t)line;
+            state->caret = qui_editor_pos_at(ctx, doc, target, (float)ctx->mouse_pos.x - ctx->layout_offset_x - padding);
+            state->preferred_x = -1.0f;
+            if (pressed_inside) state->anchor = state->caret;
+        }
+        
+        /* Typed text and keys, in the order they arrived */
+        int page_lines = (int)(height / line_height) - 1;
+        if (page_lines < 1) page_lines = 1;
+        int text_offset = 0;
+        for (int i = 0; i < ctx->key_count; i++) {
+            int until = ctx->key_text_offset[i];
+            if (until > text_offset) qui_editor_replace(doc, state, ctx->text_input + text_offset, (size_t)(until - text_offset));
+            text_offset = until;
+            qui_editor_key(ctx, doc, state, ctx->keys[i], page_lines);
+        }
+        if (ctx->text_input_length > text_offset) {
+            qui_editor_replace(doc, state, ctx->text_input + text_offset, (size_t)(ctx->text_input_length - text_offset));
+        }
+        
+        /* Scroll the caret line into view; the scrollbar catches up next frame */
+        if (state->caret != old_caret || doc->length != old_length) {
+            float caret_y = (float)qui_textdoc_line_of(doc, state->caret) * line_height;
+            float scroll_y = scroll->scroll_y;
+            if (caret_y < scroll_y) scroll_y = caret_y;
+            if (caret_y + line_height > scroll_y + height) scroll_y = caret_y + line_height - height;
+            if (scroll_y != scroll->scroll_y) {
+                scroll->scroll_y = scroll_y;
+                ctx->layout_offset_y = frame->y - scroll_y;
+                view_top = scroll_y;
+                ctx->redraw_requested = true;
+            }
+        }
+    }
+    
+    if (ctx->mouse_released && ctx->active_id == id) {
+        ctx->active_id = 0;
+    }
+    
+    qui_Rect background = qui_rect((int)view_width, (int)height, 0, (int)view_top);
+    qui_draw_rect_safe(ctx, &background, ctx->colors[QUI_COLOR_FOREGROUND]);
+    
+    /* Draw only the visible lines, one line-start lookup each */
+    size_t lo = (state->caret < state->anchor) ? state->caret : state->anchor;
+    size_t hi = (state->caret < state->anchor) ? state->anchor : state->caret;
+    int line_count = (doc->line_count > (size_t)INT_MAX) ? INT_MAX : (int)doc->line_count;
+    qui_ListClipper clipper;
+    qui_list_clipper_begin(ctx, &clipper, line_count, line_height);
+    
+    size_t line_start = qui_textdoc_line_start(doc, (size_t)clipper.display_start);
+    for (int i = clipper.display_start; i < clipper.display_end; i++) {
+        char text[QUI_EDITOR_LINE_BYTES + 1];
+        size_t next_start = qui_textdoc_line_start(doc, (size_t)i + 1);
+        size_t line_end = ((size_t)i + 1 < doc->line_count) ? next_start - 1 : doc->length;
+        size_t n = qui_editor_line_text(doc, line_start, line_end, text);
+        float y = ctx->cursor_y;
+        
+        if (focused && lo != hi && lo <= line_end && hi > line_start) {
+            float x0 = (lo > line_start) ? qui_editor_advance(ctx, text, (lo - line_start < n) ? lo - line_start : n) : 0.0f;
+            float x1 = (hi > line_end) ? qui_editor_advance(ctx, text, n) + padding
+                                       : qui_editor_advance(ctx, text, (hi - line_start < n) ? hi - line_start : n);
+            qui_Rect sel = qui_rect((int)(x1 - x0), (int)line_height, (int)(padding + x0), (int)y);
+            qui_draw_rect_safe(ctx, &sel, ctx->colors[QUI_COLOR_SELECTION]);
+        }
+        
+        if (n > 0) qui_draw_text_safe(ctx, text, padding, y + 2.0f);
+        
+        if (focused && state->caret >= line_start && state->caret <= line_end) {
+            size_t column = state->caret - line_start;
+            float caret_x = qui_editor_advance(ctx, text, (column < n) ? column : n);
+            qui_Rect caret = qui_rect(2, (int)line_height, (int)(padding + caret_x), (int)y);
+            qui_draw_rect_safe(ctx, &caret, ctx->colors[QUI_COLOR_TEXT]);
+        }
+        
+        ctx->cursor_y += line_height;
+        line_start = next_start;
+    }
+    
+    qui_list_clipper_end(ctx, &clipper);
+    qui_end_scroll_region(ctx);
+    
+    return focused ? 1 : 0;
+}
+
+#ifdef QUI_SOFTWARE_RENDERER
+
+/* ================================================================================================
+ * SOFTWARE RENDERER IMPLEMENTATION
+ * ================================================================================================ */
+
+/** @brief Blend one pixel over another using a 0-255 coverage value */
+static uint32_t qui_sw_blend_pixel(uint32_t dst, uint32_t src, uint32_t a) {
+    uint32_t ia = 255u - a;
+    uint32_t out = 0;
+    
+    /* The source alpha channel counts as fully opaque so the result is "over" */
+    src |= 0xFF000000u;
+    for (int shift = 0; shift < 32; shift += 8) {
+        uint32_t t = ((src >> shift) & 0xFFu) * a + ((dst >> shift) & 0xFFu) * ia + 128u;
+        out |= (((t + (t >> 8)) >> 8) & 0xFFu) << shift;
+    }
+    return out;
+}
+
+#ifdef QUI_SIMD_SSE2
+/** @brief Blend four pixels, each weighted by its own alpha */
+static __m128i qui_sw_blend4(__m128i src, __m128i dst) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i alpha_lanes = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+    const __m128i v255 = _mm_set1_epi16(255);
+    const __m128i v128 = _mm_set1_epi16(128);
+    
+    __m128i s_lo = _mm_unpacklo_epi8(src, zero);
+    __m128i s_hi = _mm_unpackhi_epi8(src, zero);
+    __m128i d_lo = _mm_unpacklo_epi8(dst, zero);
+    __m128i d_hi = _mm_unpackhi_epi8(dst, zero);
+    __m128i a_lo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s_lo, 0xFF), 0xFF);
+    __m128i a_hi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s_hi, 0xFF), 0xFF);
+    s_lo = _mm_or_si128(s_lo, alpha_lanes);
+    s_hi = _mm_or_si128(s_hi, alpha_lanes);
+    
+    __m128i t_lo = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(s_lo, a_lo),
+                                               _mm_mullo_epi16(d_lo, _mm_sub_epi16(v255, a_lo))), v128);
+    __m128i t_hi = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(s_hi, a_hi),
+                                               _mm_mullo_epi16(d_hi, _mm_sub_epi16(v255, a_hi))), v128);
+    t_lo = _mm_srli_epi16(_mm_add_epi16(t_lo, _mm_srli_epi16(t_lo, 8)), 8);
+    t_hi = _mm_srli_epi16(_mm_add_epi16(t_hi, _mm_srli_epi16(t_hi, 8)), 8);
+    
+    return _mm_packus_epi16(t_lo, t_hi);
+}
+#endif
+
+#ifdef QUI_SIMD_AVX2
+/** @brief Blend eight pixels, each weighted by its own alpha */
+static __m256i qui_sw_blend8(__m256i src, __m256i dst) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i alpha_lanes = _mm256_set_epi16(255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0);
+    const __m256i v255 = _mm256_set1_epi16(255);
+    const __m256i v128 = _mm256_set1_epi16(128);
+    
+    __m256i s_lo = _mm256_unpacklo_epi8(src, zero);
+    __m256i s_hi = _mm256_unpackhi_epi8(src, zero);
+    __m256i d_lo = _mm256_unpacklo_epi8(dst, zero);
+    __m256i d_hi = _mm256_unpackhi_epi8(dst, zero);
+    __m256i a_lo = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s_lo, 0xFF), 0xFF);
+    __m256i a_hi = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s_hi, 0xFF), 0xFF);
+    s_lo = _mm256_or_si256(s_lo, alpha_lanes);
+    s_hi = _mm256_or_si256(s_hi, alpha_lanes);
+    
+    __m256i t_lo = _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(s_lo, a_lo),
+                                                     _mm256_mullo_epi16(d_lo, _mm256_sub_epi16(v255, a_lo))), v128);
+    __m256i t_hi = _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(s_hi, a_hi),
+                                                     _mm256_mullo_epi16(d_hi, _mm256_sub_epi16(v255, a_hi))), v128);
+    t_lo = _mm256_srli_epi16(_mm256_add_epi16(t_lo, _mm256_srli_epi16(t_lo, 8)), 8);
+    t_hi = _mm256_srli_epi16(_mm256_add_epi16(t_hi, _mm256_srli_epi16(t_hi, 8)), 8);
+    
+    return _mm256_packus_epi16(t_lo, t_hi);
+}
+#endif
+
+/** @brief Write one color to n consecutive pixels */
+static void qui_sw_fill_span(uint32_t *dst, int n, uint32_t color) {
+    int i = 0;
+#ifdef QUI_SIMD_AVX2
+    __m256i c8 = _mm256_set1_epi32((int)color);
+    for (; i + 8 <= n; i += 8) _mm256_storeu_si256((__m256i*)(dst + i), c8);
+#endif
+#ifdef QUI_SIMD_SSE2
+    __m128i c4 = _mm_set1_epi32((int)color);
+    for (; i + 4 <= n; i += 4) _mm_storeu_si128((__m128i*)(dst + i), c4);
+#endif
+    for (; i < n; i++) dst[i] = color;
+}
+
+/** @brief Blend one translucent color over n consecutive pixels */
+static void qui_sw_blend_solid_span(uint32_t *dst, int n, uint32_t color) {
+    int i = 0;
+#ifdef QUI_SIMD_AVX2
+    __m256i c8 = _mm256_set1_epi32((int)color);
+    for (; i + 8 <= n; i += 8) {
+        __m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));
+        _mm256_storeu_si256((__m256i*)(dst + i), qui_sw_blend8(c8, d));
+    }
+#endif
+#ifdef QUI_SIMD_SSE2
+    __m128i c4 = _mm_set1_epi32((int)color);
+    for (; i + 4 <= n; i += 4) {
+        __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+        _mm_storeu_si128((__m128i*)(dst + i), qui_sw_blend4(c4, d));
+    }
+#endif
+    for (; i < n; i++) dst[i] = qui_sw_blend_pixel(dst[i], color, color >> 24);
+}
+
+/** @brief Blend n source pixels over n destination pixels using per-pixel alpha */
+static void qui_sw_blend_span(uint32_t *dst, const uint32_t *src, int n) {
+    int i = 0;
+#ifdef QUI_SIMD_AVX2
+    for (; i + 8 <= n; i += 8) {
+        __m256i sv = _mm256_loadu_si256((const __m256i*)(src + i));
+        __m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));
+        _mm256_storeu_si256((__m256i*)(dst + i), qui_sw_blend8(sv, d));
+    }
+#endif
+#ifdef QUI_SIMD_SSE2
+    for (; i + 4 <= n; i += 4) {
+        __m128i sv = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+        _mm_storeu_si128((__m128i*)(dst + i), qui_sw_blend4(sv, d));
+    }
+#endif
+    for (; i < n; i++) {
+        uint32_t a = src[i] >> 24;
+        if (a == 255u) dst[i] = src[i];
+        else if (a != 0u) dst[i] = qui_sw_blend_pixel(dst[i], src[i], a);
+    }
+}
+
+/** @brief Clip a pixel rectangle to the framebuffer clip and the scissor */
+static void qui_sw_clip(const qui_Framebuffer *fb, int *x0, int *y0, int *x1, int *y1) {
+    if (*x0 < fb->clip_x0) *x0 = fb->clip_x0;
+    if (*y0 < fb->clip_y0) *y0 = fb->clip_y0;
+    if (*x1 > fb->clip_x1) *x1 = fb->clip_x1;
+    if (*y1 > fb->clip_y1) *y1 = fb->clip_y1;
+    
+    if (fb->scissor_set) {
+        const qui_Rect *s = &fb->scissor;
+        if (*x0 < s->pos_x) *x0 = s->pos_x;
+        if (*y0 < s->pos_y) *y0 = s->pos_y;
+        if (*x1 > s->pos_x + s->width) *x1 = s->pos_x + s->width;
+        if (*y1 > s->pos_y + s->height) *y1 = s->pos_y + s->height;
+    }
+}
+
+/** @brief Fill a pixel rectangle [x0, x1) x [y0, y1), clipped to the framebuffer clip */
+static void qui_sw_fill_rect(qui_Framebuffer *fb, int x0, int y0, int x1, int y1, uint32_t color) {
+    qui_sw_clip(fb, &x0, &y0, &x1, &y1);
+    if (x0 >= x1 || y0 >= y1) return;
+    
+    uint32_t alpha = color >> 24;
+    if (alpha == 0u) return;
+    
+    uint32_t *row = fb->pixels + (size_t)y0 * (size_t)fb->stride + x0;
+    int n = x1 - x0;
+    for (int y = y0; y < y1; y++, row += fb->stride) {
+        if (alpha == 255u) qui_sw_fill_span(row, n, color);
+        else qui_sw_blend_solid_span(row, n, color);
+    }
+}
+
+/** @brief Integer scale of the built-in font for the context font size */
+static int qui_sw_text_scale(qui_Context *ctx) {
+    int scale = (int)(ctx->font_size / (float)QUI_SW_LINE_HEIGHT + 0.5f);
+    return (scale > 0) ? scale : 2;
+}
+
+static void qui_sw_draw_rect(qui_Context *ctx, float x, float y, float w, float h, qui_Color col) {
+    qui_Framebuffer *fb = (qui_Framebuffer*)ctx->render_target;
+    if (!fb) return;
+    
+    int x0 = (int)floorf(x + 0.5f);
+    int y0 = (int)floorf(y + 0.5f);
+    int x1 = (int)floorf(x + w + 0.5f);
+    int y1 = (int)floorf(y + h + 0.5f);
+    qui_sw_fill_rect(fb, x0, y0, x1, y1, qui_pack_color(col));
+}
+
+/** @brief Blend glyph coverage from an atlas font, tinted with color */
+static void qui_sw_draw_atlas_text(qui_Framebuffer *fb, const qui_Font *font, const char *text,
+                                   float x, int pen_y, uint32_t color) {
+    uint32_t alpha = color >> 24;
+    float pen = x;
+    const unsigned char *p = (const unsigned char*)text;
+    
+    while (*p) {
+        const qui_Glyph *g = qui_font_glyph(font, qui_font_next_char(&p));
+        int gx = (int)floorf(pen + g->offset_x + 0.5f);
+        int gy = pen_y + (int)floorf(g->offset_y + 0.5f);
+        int x0 = gx, y0 = gy, x1 = gx + g->width, y1 = gy + g->height;
+        pen += g->advance;
+        
+        qui_sw_clip(fb, &x0, &y0, &x1, &y1);
+        for (int py = y0; py < y1; py++) {
+            const unsigned char *cov = font->pixels + (size_t)(g->y + py - gy) * (size_t)font->atlas_width + g->x - gx;
+            uint32_t *row = fb->pixels + (size_t)py * (size_t)fb->stride;
+            for (int px = x0; px < x1; px++) {
+                uint32_t a = (cov[px] * alpha + 127u) / 255u;
+                if (a == 255u) row[px] = color | 0xFF000000u;
+                else if (a != 0u) row[px] = qui_sw_blend_pixel(row[px], color, a);
+            }
+        }
+    }
+}
+
+static void qui_sw_draw_text(qui_Context *ctx, const char *text, float x, float y) {
+    qui_Framebuffer *fb = (qui_Framebuffer*)ctx->render_target;
+    if (!fb) return;
+    
+    qui_Color32 color = ctx->colors[QUI_COLOR_TEXT];
+    int scale = qui_sw_text_scale(ctx);
+    int pen_x = (int)floorf(x + 0.5f);
+    int pen_y = (int)floorf(y + 0.5f);
+    
+    if (ctx->atlas_font) {
+        qui_sw_draw_atlas_text(fb, ctx->atlas_font, text, x, pen_y, color);
+        return;
+    }
+    
+    for (const unsigned char *c = (const unsigned char*)text; *c; c++) {
+        /* One glyph per UTF-8 sequence; anything outside ASCII draws as '?' */
+        if ((*c & 0xC0) == 0x80) continue;
+        unsigned char ch = (*c >= 32 && *c < 127) ? *c : '?';
+        const unsigned char *glyph = QUI_SW_FONT[ch - 32];
+        
+        for (int row = 0; row < QUI_SW_GLYPH_HEIGHT; row++) {
+            unsigned char bits = glyph[row];
+            int col = 0;
+            while (col < QUI_SW_GLYPH_WIDTH) {
+                if (!(bits & (0x10 >> col))) { col++; continue; }
+                int run = col;
+                while (run < QUI_SW_GLYPH_WIDTH && (bits & (0x10 >> run))) run++;
+                int gy = pen_y + row * scale;
+                qui_sw_fill_rect(fb, pen_x + col * scale, gy, pen_x + run * scale, gy + scale, color);
+                col = run;
+            }
+        }
+        pen_x += QUI_SW_GLYPH_ADVANCE * scale;
+    }
+}
+
+/** @brief Convert one source pixel with the given channel count to RGBA8 */
+static uint32_t qui_sw_fetch_pixel(const unsigned char *p, int channels) {
+    switch (channels) {
+        case 1: return (uint32_t)p[0] * 0x010101u | 0xFF000000u;
+        case 2: return (uint32_t)p[0] * 0x010101u | ((uint32_t)p[1] << 24);
+        case 3: return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | 0xFF000000u;
+        default: return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+}
+
+static void qui_sw_draw_image(qui_Context *ctx, qui_Image *img, float x, float y, float w, float h) {
+    qui_Framebuffer *fb = (qui_Framebuffer*)ctx->render_target;
+    if (!fb || !img || !img->data || img->width <= 0 || img->height <= 0) return;
+    if (img->channels < 1 || img->channels > 4) return;
+    
+    int x0 = (int)floorf(x + 0.5f);
+    int y0 = (int)floorf(y + 0.5f);
+    int x1 = (int)floorf(x + w + 0.5f);
+    int y1 = (int)floorf(y + h + 0.5f);
+    if (x1 <= x0 || y1 <= y0) return;
+    
+    /* 16.16 fixed-point source steps for nearest-neighbour sampling */
+    uint32_t step_x = (uint32_t)(((uint64_t)img->width << 16) / (uint64_t)(x1 - x0));
+    uint32_t step_y = (uint32_t)(((uint64_t)img->height << 16) / (uint64_t)(y1 - y0));
+    int cx0 = x0;
+    int cy0 = y0;
+    int cx1 = x1;
+    int cy1 = y1;
+    qui_sw_clip(fb, &cx0, &cy0, &cx1, &cy1);
+    if (cx0 >= cx1 || cy0 >= cy1) return;
+    
+    const unsigned char *pixels = (const unsigned char*)img->data;
+    int pitch_width = (img->page && img->page != img) ? img->page->width : img->width;
+    size_t src_pitch = (size_t)pitch_width * (size_t)img->channels;
+    uint32_t span[256];
+    
+    for (int py = cy0; py < cy1; py++) {
+        uint32_t sy = ((uint32_t)(py - y0) * step_y) >> 16;
+        const unsigned char *src_row = pixels + (size_t)sy * src_pitch;
+        uint32_t *dst = fb->pixels + (size_t)py * (size_t)fb->stride;
+        
+        for (int px = cx0; px < cx1; px += 256) {
+            int n = (cx1 - px < 256) ? cx1 - px : 256;
+            uint32_t sx = (uint32_t)(px - x0) * step_x;
+            for (int i = 0; i < n; i++, sx += step_x) {
+                span[i] = qui_sw_fetch_pixel(src_row + (size_t)(sx >> 16) * (size_t)img->channels, img->channels);
+            }
+            if (img->channels == 2 || img->channels == 4) qui_sw_blend_span(dst + px, span, n);
+            else memcpy(dst + px, span, sizeof(uint32_t) * (size_t)n);
+        }
+    }
+}
+
+static void qui_sw_set_clip(qui_Context *ctx, const qui_Rect *clip) {
+    qui_Framebuffer *fb = (qui_Framebuffer*)ctx->render_target;
+    if (!fb) return;
+    
+    fb->scissor_set = (clip != NULL);
+    if (clip) fb->scissor = *clip;
+}
+
+static float qui_sw_text_width(qui_Context *ctx, const char *text) {
+    int glyphs = 0;
+    for (const unsigned char *c = (const unsigned char*)text; *c; c++) {
+        if ((*c & 0xC0) != 0x80) glyphs++;
+    }
+    return (float)(glyphs * QUI_SW_GLYPH_ADVANCE * qui_sw_text_scale(ctx));
+}
+
+static float qui_sw_text_height(qui_Context *ctx, const char *text) {
+    (void)text;
+    return (float)(QUI_SW_LINE_HEIGHT * qui_sw_text_scale(ctx));
+}
+
+qui_Result qui_framebuffer_init(qui_Framebuffer *fb, uint32_t *pixels, int width, int height, int stride) {
+    QUI_VALIDATE_PTR(fb);
+    QUI_VALIDATE_PTR(pixels);
+    
+    if (width <= 0 || height <= 0 || stride < 0 || (stride > 0 && stride < width)) {
+        return QUI_ERROR_INVALID_VALUE;
+    }
+    
+    fb->pixels = pixels;
+    fb->width = width;
+    fb->height = height;
+    fb->stride = (stride > 0) ? stride : width;
+    fb->clip_x0 = 0;
+    fb->clip_y0 = 0;
+    fb->clip_x1 = width;
+    fb->clip_y1 = height;
+    fb->scissor_set = false;
+    
+    return QUI_OK;
+}
+
+qui_Result qui_framebuffer_set_clip(qui_Framebuffer *fb, const qui_Rect *clip) {
+    QUI_VALIDATE_PTR(fb);
+    
+    if (!clip) {
+        fb->clip_x0 = 0;
+        fb->clip_y0 = 0;
+        fb->clip_x1 = fb->width;
+        fb->clip_y1 = fb->height;
+        return QUI_OK;
+    }
+    
+    fb->clip_x0 = (clip->pos_x > 0) ? clip->pos_x : 0;
+    fb->clip_y0 = (clip->pos_y > 0) ? clip->pos_y : 0;
+    fb->clip_x1 = (clip->pos_x + clip->width < fb->width) ? clip->pos_x + clip->width : fb->width;
+    fb->clip_y1 = (clip->pos_y + clip->height < fb->height) ? clip->pos_y + clip->height : fb->height;
+    if (fb->clip_x1 < fb->clip_x0) fb->clip_x1 = fb->clip_x0;
+    if (fb->clip_y1 < fb->clip_y0) fb->clip_y1 = fb->clip_y0;
+    
+    return QUI_OK;
+}
+
+qui_Result qui_framebuffer_clear(qui_Framebuffer *fb, qui_Color color) {
+    QUI_VALIDATE_PTR(fb);
+    QUI_VALIDATE_PTR(fb->pixels);
+    
+    uint32_t packed = qui_pack_color(color);
+    int n = fb->clip_x1 - fb->clip_x0;
+    if (n <= 0) return QUI_OK;
+    uint32_t *row = fb->pixels + (size_t)fb->clip_y0 * (size_t)fb->stride + fb->clip_x0;
+    for (int y = fb->clip_y0; y < fb->clip_y1; y++, row += fb->stride) {
+        qui_sw_fill_span(row, n, packed);
+    }
+    
+    return QUI_OK;
+}
+
+qui_Result qui_use_software_renderer(qui_Context *ctx, qui_Framebuffer *fb) {
+    QUI_VALIDATE_CTX(ctx);
+    QUI_VALIDATE_PTR(fb);
+    
+    ctx->render_target = fb;
+    ctx->draw_rect = qui_sw_draw_rect;
+    ctx->draw_text = qui_sw_draw_text;
+    ctx->draw_image = qui_sw_draw_image;
+    ctx->set_clip = qui_sw_set_clip;
+    ctx->text_width = qui_sw_text_width;
+    ctx->text_height = qui_sw_text_height;
+    
+    /* Measurements from a previous backend no longer apply */
+    return qui_invalidate_text_cache(ctx);
+}
+
+#endif /* QUI_SOFTWARE_RENDERER */
+
 #endif /* QUI_IMPLEMENTATION */
@@ -0,0 +1,253 @@
+/* Copyright (c) 2025 csode
+ * Licensed under the GPL3 License. See LICENSE file for details.
+ */
+
+/**
+ * @file quickui.hpp
+ * @brief C++17 wrapper for QuickUI with compile-time backend dispatch
+ *
+ * qui::Context<Backend> binds a backend type at compile time. By default the context's
+ * callbacks are per-backend thunks that call the backend's static methods, which the
+ * compiler inlines into the thunk: one indirect call per primitive, as with the C API.
+ * With a draw list (max_commands > 0), end() replays the recorded frame calling the
+ * backend directly, with no indirect calls at all; recording costs more than the calls it
+ * saves with trivial backends, so use it when you want the list anyway (window ordering,
+ * batching). A backend is a type with these static members:
+ *
+ *     static void draw_rect(float x, float y, float w, float h, qui_Color32 color);
+ *     static void draw_text(const char *text, float x, float y, qui_Color32 color);
+ *     static void draw_image(qui_Image *image, float x, float y, float w, float h);
+ *     static void set_clip(const qui_Rect *clip);       // NULL disables the scissor
+ *     static float text_width(const char *text);
+ *     static float text_height(const char *text);
+ *     static const float *advances();                   // optional, see qui_set_font_advances()
+ *
+ * Widgets take either C strings or std::string_view. Views are copied once into the frame
+ * arena with their known length, and the draw list reuses that copy. Window, IdScope and
+ * ClipScope close what they open when they go out of scope.
+ *
+ * Include quickui.h with QUI_IMPLEMENTATION in exactly one translation unit, as usual.
+ */
+
+#ifndef QUICK_UI_HPP
+#define QUICK_UI_HPP
+
+#include "quickui.h"
+
+#include <string_view>
+#include <type_traits>
+
+namespace qui {
+
+namespace detail {
+
+/** @brief Detects an optional Backend::advances() table */
+template <class Backend, class = void>
+struct has_advances : std::false_type {};
+
+template <class Backend>
+struct has_advances<Backend, std::void_t<decltype(Backend::advances())>> : std::true_type {};
+
+/** @brief Copy a view into the frame arena with a terminator (NULL if the arena is full) */
+inline const char *frame_string(qui_Context *ctx, std::string_view text) {
+    return qui_frame_strndup(ctx, text.data(), text.size());
+}
+
+} // namespace detail
+
+/** @brief Window that ends itself; test it to see whether qui_begin_window() succeeded */
+class Window {
+public:
+    Window(qui_Context *ctx, const char *title, qui_Vec2 size, qui_Vec2 *pos)
+        : ctx_(ctx), open_(qui_begin_window(ctx, title, size, pos)) {}
+    Window(qui_Context *ctx, std::string_view title, qui_Vec2 size, qui_Vec2 *pos)
+        : Window(ctx, detail::frame_string(ctx, title), size, pos) {}
+    ~Window() { if (open_) qui_end_window(ctx_); }
+
+    Window(const Window &) = delete;
+    Window &operator=(const Window &) = delete;
+
+    explicit operator bool() const { return open_; }
+
+private:
+    qui_Context *ctx_;
+    bool open_;
+};
+
+/** @brief ID scope that pops itself */
+class IdScope {
+public:
+    IdScope(qui_Context *ctx, const char *name)
+        : ctx_(ctx), pushed_(qui_push_id(ctx, name) == QUI_OK) {}
+    IdScope(qui_Context *ctx, std::string_view name)
+        : ctx_(ctx), pushed_(qui_push_id_n(ctx, name.data(), name.size()) == QUI_OK) {}
+    IdScope(qui_Context *ctx, int value)
+        : ctx_(ctx), pushed_(qui_push_id_int(ctx, value) == QUI_OK) {}
+    ~IdScope() { if (pushed_) qui_pop_id(ctx_); }
+
+    IdScope(const IdScope &) = delete;
+    IdScope &operator=(const IdScope &) = delete;
+
+    explicit operator bool() const { return pushed_; }
+
+private:
+    qui_Context *ctx_;
+    bool pushed_;
+};
+
+/** @brief Clip region that pops itself */
+class ClipScope {
+public:
+    ClipScope(qui_Context *ctx, qui_Rect rect)
+        : ctx_(ctx), pushed_(qui_push_clip(ctx, rect) == QUI_OK) {}
+    ~ClipScope() { if (pushed_) qui_pop_clip(ctx_); }
+
+    ClipScope(const ClipScope &) = delete;
+    ClipScope &operator=(const ClipScope &) = delete;
+
+    explicit operator bool() const { return pushed_; }
+
+private:
+    qui_Context *ctx_;
+    bool pushed_;
+};
+
+/**
+ * @brief QuickUI context bound to a backend type at compile time
+ *
+ * Anything without a wrapper is available through the C API on raw().
+ */
+template <class Backend>
+class Context {
+public:
+    /**
+     * @brief Initialize the context
+     * @param max_commands Record into a draw list of this size and replay it in end(), or 0 to
+     *        draw as widgets run
+     * @param user_data User data pointer (ctx->user_data)
+     */
+    explicit Context(int max_commands = 0, void *user_data = nullptr) {
+        status_ = qui_init(&ctx_, user_data);
+        if (status_ != QUI_OK) return;
+
+        ctx_.draw_rect = &draw_rect_thunk;
+        ctx_.draw_text = &draw_text_thunk;
+        ctx_.draw_image = &draw_image_thunk;
+        ctx_.set_clip = &set_clip_thunk;
+        ctx_.text_width = &text_width_thunk;
+        ctx_.text_height = &text_height_thunk;
+        if constexpr (detail::has_advances<Backend>::value) {
+            qui_set_font_advances(&ctx_, Backend::advances(), nullptr);
+        }
+        if (max_commands > 0) {
+            status_ = qui_enable_draw_list(&ctx_, max_commands);
+        }
+    }
+
+    ~Context() { qui_cleanup(&ctx_); }
+
+    Context(const Context &) = delete;
+    Context &operator=(const Context &) = delete;
+
+    /** @brief Result of initialization */
+    qui_Result status() const { return status_; }
+
+    /** @brief Underlying C context */
+    qui_Context *raw() { return &ctx_; }
+
+    qui_Result begin(float start_x, float start_y) { return qui_begin(&ctx_, start_x, start_y); }
+
+    /** @brief End the frame; with a draw list, draw it through the backend */
+    qui_Result end() {
+        qui_Result result = qui_end(&ctx_);
+        const qui_DrawList *list = qui_get_draw_list(&ctx_);
+        if (result != QUI_OK || !list) return result;
+
+        const qui_DrawCmd *cmd = list->commands;
+        const qui_DrawCmd *last = list->commands + list->count;
+        for (; cmd != last; ++cmd) {
+            switch (cmd->type) {
+                case QUI_COMMAND_RECT:
+                    Backend::draw_rect(cmd->x, cmd->y, cmd->w, cmd->h, cmd->color);
+                    break;
+                case QUI_COMMAND_TEXT:
+                    Backend::draw_text(cmd->text, cmd->x, cmd->y, cmd->color);
+                    break;
+                case QUI_COMMAND_IMAGE:
+                    Backend::draw_image(cmd->image, cmd->x, cmd->y, cmd->w, cmd->h);
+                    break;
+                case QUI_COMMAND_CLIP: {
+                    qui_Rect clip = qui_rect((int)cmd->w, (int)cmd->h, (int)cmd->x, (int)cmd->y);
+                    Backend::set_clip((cmd->w < 0.0f) ? nullptr : &clip);
+                    break;
+                }
+            }
+        }
+        return QUI_OK;
+    }
+
+    /* Input */
+    qui_Result mouse_move(int x, int y) { return qui_mouse_move(&ctx_, x, y); }
+    qui_Result mouse_down(int x, int y) { return qui_mouse_down(&ctx_, x, y); }
+    qui_Result mouse_up(int x, int y) { return qui_mouse_up(&ctx_, x, y); }
+    qui_Result mouse_wheel(float delta) { return qui_mouse_wheel(&ctx_, delta); }
+    qui_Result feed_key(int key) { return qui_feed_key(&ctx_, key); }
+    qui_Result feed_text(const char *utf8) { return qui_feed_text(&ctx_, utf8); }
+
+    /* Widgets (same results as the C functions) */
+    int button(const char *label) { return qui_button(&ctx_, label); }
+    int button(std::string_view label) { return qui_button(&ctx_, frame_string(label)); }
+
+    int checkbox(const char *label, int *value) { return qui_checkbox(&ctx_, label, value); }
+    int checkbox(std::string_view label, int *value) { return qui_checkbox(&ctx_, frame_string(label), value); }
+
+    int slider(const char *label, float *value, float min_val, float max_val, float width) {
+        return qui_slider(&ctx_, label, value, min_val, max_val, width);
+    }
+    int slider(std::string_view label, float *value, float min_val, float max_val, float width) {
+        return qui_slider(&ctx_, frame_string(label), value, min_val, max_val, width);
+    }
+
+    int textbox(char *buffer, size_t capacity, float width) { return qui_textbox(&ctx_, buffer, capacity, width); }
+
+    int image_button(qui_Image *image, float button_width, float button_height, float img_width, float img_height) {
+        return qui_image_button(&ctx_, image, button_width, button_height, img_width, img_height);
+    }
+    int image_button_with_label(qui_Image *image, std::string_view label, float img_width, float img_height) {
+        return qui_image_button_with_label(&ctx_, image, frame_string(label), img_width, img_height);
+    }
+    int image_button_vertical(qui_Image *image, std::string_view label, float img_width, float img_height) {
+        return qui_image_button_vertical(&ctx_, image, frame_string(label), img_width, img_height);
+    }
+
+    /* Scopes */
+    Window window(const char *title, qui_Vec2 size, qui_Vec2 *pos) { return Window(&ctx_, title, size, pos); }
+    Window window(std::string_view title, qui_Vec2 size, qui_Vec2 *pos) { return Window(&ctx_, title, size, pos); }
+    IdScope id(const char *name) { return IdScope(&ctx_, name); }
+    IdScope id(std::string_view name) { return IdScope(&ctx_, name); }
+    IdScope id(int value) { return IdScope(&ctx_, value); }
+    ClipScope clip(qui_Rect rect) { return ClipScope(&ctx_, rect); }
+
+private:
+    static void draw_rect_thunk(qui_Context *, float x, float y, float w, float h, qui_Color color) {
+        Backend::draw_rect(x, y, w, h, qui_pack_color(color));
+    }
+    static void draw_text_thunk(qui_Context *ctx, const char *text, float x, float y) {
+        Backend::draw_text(text, x, y, ctx->colors[QUI_COLOR_TEXT]);
+    }
+    static void draw_image_thunk(qui_Context *, qui_Image *image, float x, float y, float w, float h) {
+        Backend::draw_image(image, x, y, w, h);
+    }
+    static void set_clip_thunk(qui_Context *, const qui_Rect *clip) { Backend::set_clip(clip); }
+    static float text_width_thunk(qui_Context *, const char *text) { return Backend::text_width(text); }
+    static float text_height_thunk(qui_Context *, const char *text) { return Backend::text_height(text); }
+
+    const char *frame_string(std::string_view text) { return detail::frame_string(&ctx_, text); }
+
+    qui_Context ctx_;
+    qui_Result status_;
+};
+
+} // namespace qui
+
+#endif /* QUICK_UI_HPP */